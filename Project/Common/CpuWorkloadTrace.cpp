@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "CpuWorkloadTrace.h"
+
+namespace ApiWithoutSecrets {
+
+  char const * GetCpuWorkloadDistributionName( CpuWorkloadDistribution distribution ) {
+    switch( distribution ) {
+    case CpuWorkloadDistribution::Constant:
+      return "Constant";
+    case CpuWorkloadDistribution::Normal:
+      return "Normal";
+    case CpuWorkloadDistribution::LogNormal:
+      return "Log-normal";
+    case CpuWorkloadDistribution::PeriodicSpikes:
+      return "Periodic spikes";
+    default:
+      return "Unknown";
+    }
+  }
+
+  CpuWorkloadTrace::CpuWorkloadTrace() :
+    Frames() {
+  }
+
+  bool CpuWorkloadTrace::LoadFromFile( std::string const & filename ) {
+    std::ifstream file( filename );
+    if( file.fail() ) {
+      return false;
+    }
+
+    // Each line contains pre- and post-submit times in milliseconds, lines starting with '#' are comments
+    std::vector<CpuWorkloadTraceFrame> frames;
+    std::string line;
+    while( std::getline( file, line ) ) {
+      if( line.empty() || (line[0] == '#') ) {
+        continue;
+      }
+      std::istringstream line_stream( line );
+      CpuWorkloadTraceFrame frame;
+      if( !(line_stream >> frame.PreSubmitTime >> frame.PostSubmitTime) ) {
+        return false;
+      }
+      frame.PreSubmitTime = std::max( frame.PreSubmitTime, 0.0f );
+      frame.PostSubmitTime = std::max( frame.PostSubmitTime, 0.0f );
+      frames.push_back( frame );
+    }
+    if( frames.empty() ) {
+      return false;
+    }
+
+    Frames = std::move( frames );
+    return true;
+  }
+
+  void CpuWorkloadTrace::Generate( CpuWorkloadDistribution distribution, float pre_submit_time, float post_submit_time, float deviation, uint32_t frames_count, uint32_t seed ) {
+    static const uint32_t spike_period = 30;
+    static const float spike_scale = 4.0f;
+
+    // Deviation is relative to the mean so both phases have the same shape of variance
+    deviation = std::max( deviation, 0.001f );
+    std::mt19937 generator( seed );
+    std::normal_distribution<float> normal( 1.0f, deviation );
+    // Parameters chosen so the log-normal distribution has a mean equal to 1
+    float sigma = std::sqrt( std::log( 1.0f + deviation * deviation ) );
+    std::lognormal_distribution<float> log_normal( -0.5f * sigma * sigma, sigma );
+
+    Frames.resize( frames_count );
+    for( uint32_t i = 0; i < frames_count; ++i ) {
+      float factor = 1.0f;
+      switch( distribution ) {
+      case CpuWorkloadDistribution::Normal:
+        factor = normal( generator );
+        break;
+      case CpuWorkloadDistribution::LogNormal:
+        factor = log_normal( generator );
+        break;
+      case CpuWorkloadDistribution::PeriodicSpikes:
+        factor = ((i % spike_period) == 0) ? spike_scale : 1.0f;
+        break;
+      default:
+        break;
+      }
+      factor = std::max( factor, 0.0f );
+      Frames[i].PreSubmitTime = pre_submit_time * factor;
+      Frames[i].PostSubmitTime = post_submit_time * factor;
+    }
+  }
+
+  void CpuWorkloadTrace::Clear() {
+    Frames.clear();
+  }
+
+  bool CpuWorkloadTrace::IsEmpty() const {
+    return Frames.empty();
+  }
+
+  size_t CpuWorkloadTrace::GetSize() const {
+    return Frames.size();
+  }
+
+  CpuWorkloadTraceFrame const & CpuWorkloadTrace::GetFrame( uint64_t frame_index ) const {
+    return Frames[frame_index % Frames.size()];
+  }
+
+  CpuWorkloadTrace::~CpuWorkloadTrace() {
+  }
+
+} // namespace ApiWithoutSecrets
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(CPU_WORKLOAD_TRACE_HEADER)
+#define CPU_WORKLOAD_TRACE_HEADER
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // CpuWorkloadDistribution                                      //
+  //                                                              //
+  // Distributions used to generate per-frame CPU costs           //
+  // ************************************************************ //
+  enum class CpuWorkloadDistribution : int {
+    Constant,
+    Normal,
+    LogNormal,
+    PeriodicSpikes,
+    Count
+  };
+
+  char const * GetCpuWorkloadDistributionName( CpuWorkloadDistribution distribution );
+
+  // ************************************************************ //
+  // CpuWorkloadTraceFrame                                        //
+  //                                                              //
+  // CPU work times of a single frame in milliseconds             //
+  // ************************************************************ //
+  struct CpuWorkloadTraceFrame {
+    float   PreSubmitTime;
+    float   PostSubmitTime;
+
+    CpuWorkloadTraceFrame() :
+      PreSubmitTime( 0.0f ),
+      PostSubmitTime( 0.0f ) {
+    }
+  };
+
+  // ************************************************************ //
+  // CpuWorkloadTrace                                             //
+  //                                                              //
+  // Sequence of per-frame CPU costs which is replayed in a loop; //
+  // traces are loaded from text files with pre- and post-submit  //
+  // times in each line or are generated from a fixed seed, so    //
+  // every run replays the same costs                             //
+  // ************************************************************ //
+  class CpuWorkloadTrace {
+  public:
+    bool                            LoadFromFile( std::string const & filename );
+    void                            Generate( CpuWorkloadDistribution distribution, float pre_submit_time, float post_submit_time, float deviation, uint32_t frames_count, uint32_t seed );
+    void                            Clear();
+
+    bool                            IsEmpty() const;
+    size_t                          GetSize() const;
+    CpuWorkloadTraceFrame const   & GetFrame( uint64_t frame_index ) const;
+
+    CpuWorkloadTrace();
+    ~CpuWorkloadTrace();
+
+  private:
+    std::vector<CpuWorkloadTraceFrame>  Frames;
+  };
+
+} // namespace ApiWithoutSecrets
+
+#endif // CPU_WORKLOAD_TRACE_HEADER
@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "CpuWorkloads.h"
+
+namespace ApiWithoutSecrets {
+
+  char const * GetCpuWorkloadName( CpuWorkload workload ) {
+    switch( workload ) {
+    case CpuWorkload::Trigonometry:
+      return "Trigonometry";
+    case CpuWorkload::MemoryStreaming:
+      return "Memory streaming";
+    case CpuWorkload::PointerChasing:
+      return "Pointer chasing";
+    case CpuWorkload::VectorMath:
+      return "Vector math";
+    case CpuWorkload::BranchyLogic:
+      return "Branchy logic";
+    default:
+      return "Unknown";
+    }
+  }
+
+  CpuWorkloadData::CpuWorkloadData() :
+    StreamSource(),
+    StreamTarget(),
+    StreamOffset( 0 ),
+    ChainIndices(),
+    ChainPosition( 0 ),
+    VectorData(),
+    Agents(),
+    RandomState( 0x12345678 ),
+    Result( 0.0f ) {
+  }
+
+  void CpuWorkloadData::Perform( CpuWorkload workload, long long duration, float seed ) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    long long calculations_time = 0;
+
+    // Each kernel performs a small chunk of work between time checks
+    do {
+      switch( workload ) {
+      case CpuWorkload::MemoryStreaming:
+        PerformMemoryStreaming( seed );
+        break;
+      case CpuWorkload::PointerChasing:
+        PerformPointerChasing();
+        break;
+      case CpuWorkload::VectorMath:
+        PerformVectorMath( seed );
+        break;
+      case CpuWorkload::BranchyLogic:
+        PerformBranchyLogic();
+        break;
+      default:
+        PerformTrigonometry( seed );
+        break;
+      }
+
+      calculations_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
+    } while( calculations_time < duration );
+  }
+
+  void CpuWorkloadData::PerformTrigonometry( float seed ) {
+    float _sin = std::sin( std::cos( seed ) );
+    float _pow = std::pow( seed, _sin );
+    Result = std::cos( std::sin( _pow ) );
+  }
+
+  void CpuWorkloadData::PerformMemoryStreaming( float seed ) {
+    static const size_t chunk_size = 16 * 1024;
+
+    // Two buffers fill the whole working set so every pass goes through the memory, not caches
+    if( StreamSource.empty() ) {
+      StreamSource.resize( WorkingSetSize / (2 * sizeof( float )), 1.0f );
+      StreamTarget.resize( WorkingSetSize / (2 * sizeof( float )), 0.0f );
+    }
+
+    float * source = &StreamSource[StreamOffset];
+    float * target = &StreamTarget[StreamOffset];
+    for( size_t i = 0; i < chunk_size; ++i ) {
+      target[i] = source[i] * seed + target[i] * 0.5f;
+    }
+    Result = target[0];
+    StreamOffset = (StreamOffset + chunk_size) % StreamSource.size();
+  }
+
+  void CpuWorkloadData::PerformPointerChasing() {
+    static const size_t chunk_size = 4 * 1024;
+
+    // Indices form a single random cycle (Sattolo's algorithm) so each read depends on the previous one
+    if( ChainIndices.empty() ) {
+      ChainIndices.resize( WorkingSetSize / sizeof( uint32_t ) );
+      for( uint32_t i = 0; i < static_cast<uint32_t>(ChainIndices.size()); ++i ) {
+        ChainIndices[i] = i;
+      }
+      for( uint32_t i = static_cast<uint32_t>(ChainIndices.size()) - 1; i > 0; --i ) {
+        std::swap( ChainIndices[i], ChainIndices[GetRandom() % i] );
+      }
+    }
+
+    uint32_t position = ChainPosition;
+    for( size_t i = 0; i < chunk_size; ++i ) {
+      position = ChainIndices[position];
+    }
+    ChainPosition = position;
+    Result = static_cast<float>(position);
+  }
+
+  void CpuWorkloadData::PerformVectorMath( float seed ) {
+    static const size_t data_size = 4 * 1024;
+    static const int iterations_count = 16;
+
+    if( VectorData.empty() ) {
+      VectorData.resize( data_size );
+      for( size_t i = 0; i < data_size; ++i ) {
+        VectorData[i] = static_cast<float>(i) / static_cast<float>(data_size);
+      }
+    }
+
+    // Independent iterations over a small array are easily vectorized by a compiler
+    float a = 0.5f + 0.25f * std::sin( seed );
+    float * data = VectorData.data();
+    for( int j = 0; j < iterations_count; ++j ) {
+      for( size_t i = 0; i < data_size; ++i ) {
+        float x = data[i];
+        data[i] = ((x * a + 0.25f) * x + 0.125f) * x * 0.5f;
+      }
+    }
+    Result = data[0];
+  }
+
+  void CpuWorkloadData::PerformBranchyLogic() {
+    static const size_t agents_count = 4 * 1024;
+    static const size_t chunk_size = 1024;
+
+    if( Agents.empty() ) {
+      Agents.resize( agents_count );
+      for( auto & agent : Agents ) {
+        agent.Position[0] = static_cast<float>(GetRandom() % 1000);
+        agent.Position[1] = static_cast<float>(GetRandom() % 1000);
+        agent.Target[0] = agent.Position[0];
+        agent.Target[1] = agent.Position[1];
+        agent.State = GetRandom() % 4;
+        agent.Counter = 0;
+      }
+    }
+
+    // Simple state machine with unpredictable transitions
+    for( size_t i = 0; i < chunk_size; ++i ) {
+      auto & agent = Agents[GetRandom() % agents_count];
+      switch( agent.State ) {
+      case 0:   // Idle
+        if( (GetRandom() & 7) == 0 ) {
+          agent.State = 1;
+        }
+        break;
+      case 1:   // Choose a target
+        agent.Target[0] = static_cast<float>(GetRandom() % 1000);
+        agent.Target[1] = static_cast<float>(GetRandom() % 1000);
+        agent.State = 2;
+        break;
+      case 2: { // Move
+        float dx = agent.Target[0] - agent.Position[0];
+        float dy = agent.Target[1] - agent.Position[1];
+        if( (dx * dx + dy * dy) < 4.0f ) {
+          agent.State = (GetRandom() & 1) ? 0 : 3;
+        } else {
+          agent.Position[0] += (dx > 0.0f) ? 1.0f : -1.0f;
+          agent.Position[1] += (dy > 0.0f) ? 1.0f : -1.0f;
+        }
+        break;
+      }
+      default:  // Interact
+        if( ++agent.Counter > (GetRandom() & 15) ) {
+          agent.Counter = 0;
+          agent.State = 0;
+        }
+        break;
+      }
+    }
+    Result = Agents[0].Position[0];
+  }
+
+  uint32_t CpuWorkloadData::GetRandom() {
+    // Xorshift generator
+    RandomState ^= RandomState << 13;
+    RandomState ^= RandomState >> 17;
+    RandomState ^= RandomState << 5;
+    return RandomState;
+  }
+
+  CpuWorkloadData::~CpuWorkloadData() {
+  }
+
+} // namespace ApiWithoutSecrets
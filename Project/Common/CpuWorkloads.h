@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(CPU_WORKLOADS_HEADER)
+#define CPU_WORKLOADS_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // CpuWorkload                                                  //
+  //                                                              //
+  // Kinds of synthetic CPU work stressing different parts of a   //
+  // CPU and memory subsystem                                     //
+  // ************************************************************ //
+  enum class CpuWorkload : int {
+    Trigonometry,                 // <- Transcendental functions on registers only
+    MemoryStreaming,              // <- Sequential reads and writes of a buffer larger than caches
+    PointerChasing,               // <- Dependent random reads, latency bound
+    VectorMath,                   // <- Vectorizable arithmetic on data resident in L1 cache
+    BranchyLogic,                 // <- Data-dependent branches similar to AI or gameplay code
+    Count
+  };
+
+  char const * GetCpuWorkloadName( CpuWorkload workload );
+
+  // ************************************************************ //
+  // CpuWorkloadData                                              //
+  //                                                              //
+  // Working set of a single thread performing synthetic work;    //
+  // each kernel runs for a requested duration in microseconds,   //
+  // its memory is prepared during the first use                  //
+  // ************************************************************ //
+  class CpuWorkloadData {
+  public:
+    static const size_t   WorkingSetSize = 16 * 1024 * 1024;
+
+    void    Perform( CpuWorkload workload, long long duration, float seed );
+
+    CpuWorkloadData();
+    ~CpuWorkloadData();
+
+  private:
+    struct AgentData {
+      float       Position[2];
+      float       Target[2];
+      uint32_t    State;
+      uint32_t    Counter;
+    };
+
+    std::vector<float>      StreamSource;
+    std::vector<float>      StreamTarget;
+    size_t                  StreamOffset;
+    std::vector<uint32_t>   ChainIndices;
+    uint32_t                ChainPosition;
+    std::vector<float>      VectorData;
+    std::vector<AgentData>  Agents;
+    uint32_t                RandomState;
+    volatile float          Result;           // <- Prevents compiler from removing calculations
+
+    void    PerformTrigonometry( float seed );
+    void    PerformMemoryStreaming( float seed );
+    void    PerformPointerChasing();
+    void    PerformVectorMath( float seed );
+    void    PerformBranchyLogic();
+    uint32_t  GetRandom();
+  };
+
+} // namespace ApiWithoutSecrets
+
+#endif // CPU_WORKLOADS_HEADER
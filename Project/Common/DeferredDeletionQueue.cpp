@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DeferredDeletionQueue.h"
+
+namespace ApiWithoutSecrets {
+
+  DeferredDeletionQueue::DeferredDeletionQueue() :
+    Entries() {
+  }
+
+  void DeferredDeletionQueue::Release( uint64_t completed_frame_number ) {
+    // Frame numbers are pushed in a non-decreasing order
+    while( !Entries.empty() &&
+           (Entries.front()->FrameNumber <= completed_frame_number) ) {
+      Entries.pop_front();
+    }
+  }
+
+  void DeferredDeletionQueue::ReleaseAll() {
+    while( !Entries.empty() ) {
+      Entries.pop_front();
+    }
+  }
+
+  size_t DeferredDeletionQueue::GetSize() const {
+    return Entries.size();
+  }
+
+  DeferredDeletionQueue::~DeferredDeletionQueue() {
+    ReleaseAll();
+  }
+
+} // namespace ApiWithoutSecrets
@@ -0,0 +1,79 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(DEFERRED_DELETION_QUEUE_HEADER)
+#define DEFERRED_DELETION_QUEUE_HEADER
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <type_traits>
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // DeferredDeletionQueue                                        //
+  //                                                              //
+  // Class keeping objects alive until the frame with a given     //
+  // number is finished; objects can be of any movable type, i.e. //
+  // vk::Unique* handles or structs which contain them            //
+  // ************************************************************ //
+  class DeferredDeletionQueue {
+  public:
+    template<class T>
+    void    Push( uint64_t frame_number, T && object );
+    void    Release( uint64_t completed_frame_number );
+    void    ReleaseAll();
+    size_t  GetSize() const;
+
+    DeferredDeletionQueue();
+    ~DeferredDeletionQueue();
+
+  private:
+    struct EntryBase {
+      uint64_t  FrameNumber;
+
+      EntryBase( uint64_t frame_number ) :
+        FrameNumber( frame_number ) {
+      }
+
+      virtual ~EntryBase() {
+      }
+    };
+
+    template<class T>
+    struct Entry : public EntryBase {
+      T         Object;
+
+      Entry( uint64_t frame_number, T && object ) :
+        EntryBase( frame_number ),
+        Object( std::move( object ) ) {
+      }
+    };
+
+    std::deque<std::unique_ptr<EntryBase>>  Entries;
+  };
+
+  template<class T>
+  void DeferredDeletionQueue::Push( uint64_t frame_number, T && object ) {
+    static_assert( !std::is_lvalue_reference<T>::value, "Ownership of an object must be transferred to the queue" );
+    // Objects are destroyed in the order in which they were pushed
+    Entries.emplace_back( new Entry<T>( frame_number, std::move( object ) ) );
+  }
+
+} // namespace ApiWithoutSecrets
+
+#endif // DEFERRED_DELETION_QUEUE_HEADER
@@ -0,0 +1,93 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DescriptorWriter.h"
+
+namespace ApiWithoutSecrets {
+
+  DescriptorWriter::DescriptorWriter() :
+    Writes(),
+    ImageInfos(),
+    BufferInfos(),
+    DescriptorWrites() {
+  }
+
+  void DescriptorWriter::WriteImage( vk::DescriptorSet const & descriptor_set, vk::DescriptorType descriptor_type, uint32_t binding, uint32_t array_element, vk::DescriptorImageInfo const & image_info ) {
+    if( !Merge( descriptor_set, descriptor_type, binding, array_element, true ) ) {
+      PendingWrite write = { descriptor_set, descriptor_type, binding, array_element, 1, static_cast<uint32_t>(ImageInfos.size()), true };
+      Writes.push_back( write );
+    }
+    ImageInfos.push_back( image_info );
+  }
+
+  void DescriptorWriter::WriteBuffer( vk::DescriptorSet const & descriptor_set, vk::DescriptorType descriptor_type, uint32_t binding, uint32_t array_element, vk::DescriptorBufferInfo const & buffer_info ) {
+    if( !Merge( descriptor_set, descriptor_type, binding, array_element, false ) ) {
+      PendingWrite write = { descriptor_set, descriptor_type, binding, array_element, 1, static_cast<uint32_t>(BufferInfos.size()), false };
+      Writes.push_back( write );
+    }
+    BufferInfos.push_back( buffer_info );
+  }
+
+  bool DescriptorWriter::Merge( vk::DescriptorSet const & descriptor_set, vk::DescriptorType descriptor_type, uint32_t binding, uint32_t array_element, bool image_infos ) {
+    if( Writes.empty() ) {
+      return false;
+    }
+    // Infos of the last write are always at the end of their array, so a next element can be appended to it
+    PendingWrite & last_write = Writes.back();
+    if( (last_write.DescriptorSet != descriptor_set) ||
+        (last_write.DescriptorType != descriptor_type) ||
+        (last_write.Binding != binding) ||
+        (last_write.ArrayElement + last_write.DescriptorCount != array_element) ||
+        (last_write.ImageInfos != image_infos) ) {
+      return false;
+    }
+    ++last_write.DescriptorCount;
+    return true;
+  }
+
+  void DescriptorWriter::Flush( vk::Device const & device ) {
+    if( Writes.empty() ) {
+      return;
+    }
+
+    DescriptorWrites.clear();
+    for( auto & write : Writes ) {
+      DescriptorWrites.emplace_back(
+        write.DescriptorSet,                                          // VkDescriptorSet                dstSet
+        write.Binding,                                                // uint32_t                       dstBinding
+        write.ArrayElement,                                           // uint32_t                       dstArrayElement
+        write.DescriptorCount,                                        // uint32_t                       descriptorCount
+        write.DescriptorType,                                         // VkDescriptorType               descriptorType
+        write.ImageInfos ? &ImageInfos[write.FirstInfo] : nullptr,    // const VkDescriptorImageInfo   *pImageInfo
+        write.ImageInfos ? nullptr : &BufferInfos[write.FirstInfo],   // const VkDescriptorBufferInfo  *pBufferInfo
+        nullptr                                                       // const VkBufferView            *pTexelBufferView
+      );
+    }
+    device.updateDescriptorSets( static_cast<uint32_t>(DescriptorWrites.size()), DescriptorWrites.data(), 0, nullptr );
+    Clear();
+  }
+
+  void DescriptorWriter::Clear() {
+    Writes.clear();
+    ImageInfos.clear();
+    BufferInfos.clear();
+  }
+
+  uint32_t DescriptorWriter::GetPendingWritesCount() const {
+    return static_cast<uint32_t>(Writes.size());
+  }
+
+} // namespace ApiWithoutSecrets
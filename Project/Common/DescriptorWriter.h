@@ -0,0 +1,66 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(DESCRIPTOR_WRITER_HEADER)
+#define DESCRIPTOR_WRITER_HEADER
+
+#include <cstdint>
+#include <vector>
+#include "vulkan.hpp"
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // DescriptorWriter                                             //
+  //                                                              //
+  // Accumulates descriptor writes of any number of sets and      //
+  // issues all of them with a single vkUpdateDescriptorSets()    //
+  // call; writes to consecutive array elements of the same       //
+  // binding are merged into one VkWriteDescriptorSet             //
+  // ************************************************************ //
+  class DescriptorWriter {
+  public:
+    DescriptorWriter();
+
+    void                            WriteImage( vk::DescriptorSet const & descriptor_set, vk::DescriptorType descriptor_type, uint32_t binding, uint32_t array_element, vk::DescriptorImageInfo const & image_info );
+    void                            WriteBuffer( vk::DescriptorSet const & descriptor_set, vk::DescriptorType descriptor_type, uint32_t binding, uint32_t array_element, vk::DescriptorBufferInfo const & buffer_info );
+    void                            Flush( vk::Device const & device );
+    void                            Clear();
+
+    uint32_t                        GetPendingWritesCount() const;
+
+  private:
+    struct PendingWrite {
+      vk::DescriptorSet             DescriptorSet;
+      vk::DescriptorType            DescriptorType;
+      uint32_t                      Binding;
+      uint32_t                      ArrayElement;
+      uint32_t                      DescriptorCount;
+      uint32_t                      FirstInfo;          // <- Index into image or buffer infos, pointers are resolved during flush
+      bool                          ImageInfos;
+    };
+
+    bool                            Merge( vk::DescriptorSet const & descriptor_set, vk::DescriptorType descriptor_type, uint32_t binding, uint32_t array_element, bool image_infos );
+
+    std::vector<PendingWrite>               Writes;
+    std::vector<vk::DescriptorImageInfo>    ImageInfos;
+    std::vector<vk::DescriptorBufferInfo>   BufferInfos;
+    std::vector<vk::WriteDescriptorSet>     DescriptorWrites;   // <- Kept between flushes so its storage is reused
+  };
+
+} // namespace ApiWithoutSecrets
+
+#endif // DESCRIPTOR_WRITER_HEADER
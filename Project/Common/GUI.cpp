@@ -14,14 +14,23 @@
 // under the License.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include "SampleCommon.h"
 #include "VulkanFunctions.h"
+#include "VulkanCallCounters.h"
 #include "imgui/imgui.h"
 
 namespace ApiWithoutSecrets {
 
   GUI::GUI( const SampleCommon &parent ) :
-    Parent( parent ) {
+    Parent( parent ),
+    Vulkan(),
+    StreamedBytes( 0 ),
+    CacheOverlay( false ),
+    OverlayUpdateInterval( 10 ),
+    FramesSinceOverlayUpdate( 0 ),
+    OverlayValid( false ),
+    DrawDataHash( 0 ) {
   }
 
   void GUI::Prepare( size_t resource_count, uint32_t width, uint32_t height ) {
@@ -42,11 +51,16 @@ namespace ApiWithoutSecrets {
     CreateDescriptorResources();
     CreatePipelineLayout();
     CreateGraphicsPipeline();
+    CreateOverlayResources( width, height );
   }
 
   void GUI::OnWindowSizeChanged( uint32_t width, uint32_t height ) {
     ImGui::GetIO().DisplaySize.x = static_cast<float>(width);
     ImGui::GetIO().DisplaySize.y = static_cast<float>(height);
+
+    if( Vulkan.OverlayRenderPass ) {
+      CreateOverlayImage( width, height );
+    }
   }
 
   void GUI::StartFrame( TimerData const & timer, OS::ProjectBase::MouseInputStateData & mouse_state ) {
@@ -61,7 +75,7 @@ namespace ApiWithoutSecrets {
     ImGui::NewFrame();
 
     ImGui::SetNextWindowPos( ImVec2( io.DisplaySize.x - 120.0f, 20.0f ) );
-    ImGui::SetNextWindowSize( ImVec2( 100.0f, 100.0 ) );
+    ImGui::SetNextWindowSize( ImVec2( 100.0f, 165.0 ) );
     ImGui::Begin( "Stats", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoScrollbar );
 
     static bool show_fps = true;
@@ -88,13 +102,92 @@ namespace ApiWithoutSecrets {
       ImGui::PlotHistogram( "", histogram.data(), static_cast<int>(histogram.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2( 85.0f, 30.0f ) );
     }
 
+    // Amount of GUI vertex and index data written in the previous frame
+    ImGui::Text( "GUI%6.1f KB", StreamedBytes / 1024.0f );
+
+    // Cached overlay is re-rendered only when GUI changes, but not more often than every N frames
+    if( ImGui::Checkbox( "Cache", &CacheOverlay ) ) {
+      OverlayValid = false;
+    }
+    ImGui::PushItemWidth( 85.0f );
+    ImGui::SliderInt( "##OverlayUpdateInterval", &OverlayUpdateInterval, 1, 60 );
+    ImGui::PopItemWidth();
+
     ImGui::End();
+
+#if defined(VULKAN_CALL_COUNTERS)
+    // Vulkan calls performed during the previous frame; object creations and destructions are highlighted
+    {
+      static const size_t max_entries = 15;
+
+      ImGui::SetNextWindowPos( ImVec2( io.DisplaySize.x - 320.0f, 205.0f ) );
+      ImGui::Begin( "Vulkan calls", nullptr, ImGuiWindowFlags_AlwaysAutoResize );
+      ImGui::Text( "Calls per frame: %u", CallCounters::GetLastFrameTotalCount() );
+      ImGui::Text( "Objects created/destroyed: %u", CallCounters::GetLastFrameObjectLifetimeCount() );
+      ImGui::Separator();
+
+      auto & entries = CallCounters::GetLastFrameEntries();
+      for( size_t i = 0; (i < entries.size()) && (i < max_entries); ++i ) {
+        if( entries[i].ObjectLifetime ) {
+          ImGui::TextColored( ImVec4( 1.0f, 0.4f, 0.3f, 1.0f ), "%5u  %s", entries[i].Count, entries[i].Name );
+        } else {
+          ImGui::Text( "%5u  %s", entries[i].Count, entries[i].Name );
+        }
+      }
+      ImGui::End();
+    }
+#endif
+
     ImGui::SetNextWindowPos( ImVec2( 20.0f, 20.0f ) );
   }
 
+  void GUI::SkipFrame() {
+    // Frame was started but nothing will be rendered (i.e. when swapchain image couldn't be acquired)
+    ImGui::EndFrame();
+  }
+
   void GUI::Draw( uint32_t resource_index, vk::CommandBuffer & command_buffer, vk::RenderPass const & render_pass, vk::Framebuffer const & framebuffer ) {
+    ImGui::Render();
+
+    // Check if cached overlay needs to be updated
+    bool update_overlay = false;
+    if( CacheOverlay ) {
+      ++FramesSinceOverlayUpdate;
+      if( !OverlayValid ||
+          (FramesSinceOverlayUpdate >= OverlayUpdateInterval) ) {
+        uint64_t draw_data_hash = CalculateDrawDataHash();
+        update_overlay = !OverlayValid || (draw_data_hash != DrawDataHash);
+        DrawDataHash = draw_data_hash;
+        // Cached overlay is refreshed (or confirmed to be up to date), so the hash is checked again after a full interval
+        FramesSinceOverlayUpdate = 0;
+      }
+    }
+
     // Begin command buffer
     command_buffer.begin( { vk::CommandBufferUsageFlagBits::eOneTimeSubmit } );
+    // Render GUI into the overlay image
+    if( update_overlay ) {
+      vk::ClearValue clear_value = vk::ClearColorValue( std::array<float, 4>{ 0.0f, 0.0f, 0.0f, 0.0f } );
+
+      vk::RenderPassBeginInfo render_pass_begin_info(
+        *Vulkan.OverlayRenderPass,                          // VkRenderPass                           renderPass
+        *Vulkan.OverlayFramebuffer,                         // VkFramebuffer                          framebuffer
+        {                                                   // VkRect2D                               renderArea
+          vk::Offset2D(),                                     // VkOffset2D                             offset
+          Parent.GetSwapChain().Extent,                       // VkExtent2D                             extent;
+        },
+        1,                                                  // uint32_t                               clearValueCount
+        &clear_value                                        // const VkClearValue                    *pClearValues
+      );
+      command_buffer.beginRenderPass( render_pass_begin_info, vk::SubpassContents::eInline );
+      BindPipeline( command_buffer, *Vulkan.OverlayPipeline, *Vulkan.DescriptorSet.Handle );
+      DrawFrameData( command_buffer, Vulkan.DrawingResources[resource_index] );
+      command_buffer.endRenderPass();
+
+      OverlayValid = true;
+    } else if( CacheOverlay ) {
+      StreamedBytes = 0;
+    }
     // Begin render pass
     {
       vk::RenderPassBeginInfo render_pass_begin_info(
@@ -107,23 +200,11 @@ namespace ApiWithoutSecrets {
       );
       command_buffer.beginRenderPass( render_pass_begin_info, vk::SubpassContents::eInline );
     }
-    // Bind pipeline and set pipeline state
-    {
-      command_buffer.bindPipeline( vk::PipelineBindPoint::eGraphics, *Vulkan.GraphicsPipeline );
-      command_buffer.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, *Vulkan.PipelineLayout, 0, { *Vulkan.DescriptorSet.Handle }, {} );
-
-      vk::Viewport viewport(
-        0.0f,                                               // float                                  x
-        0.0f,                                               // float                                  y
-        ImGui::GetIO().DisplaySize.x,                       // float                                  width
-        ImGui::GetIO().DisplaySize.y,                       // float                                  height
-        0.0f,                                               // float                                  minDepth
-        1.0f                                                // float                                  maxDepth
-      );
-      command_buffer.setViewport( 0, { viewport } );
-    }
     // Draw
-    {
+    if( CacheOverlay ) {
+      DrawOverlay( command_buffer );
+    } else {
+      BindPipeline( command_buffer, *Vulkan.GraphicsPipeline, *Vulkan.DescriptorSet.Handle );
       DrawFrameData( command_buffer, Vulkan.DrawingResources[resource_index] );
     }
     // End command buffer
@@ -133,37 +214,91 @@ namespace ApiWithoutSecrets {
     }
   }
 
-  void GUI::DrawFrameData( vk::CommandBuffer & command_buffer, GUIResources::DrawDataParameters &drawing_resources ) {
-    ImGui::Render();
+  void GUI::BindPipeline( vk::CommandBuffer & command_buffer, vk::Pipeline const & pipeline, vk::DescriptorSet const & descriptor_set ) {
+    command_buffer.bindPipeline( vk::PipelineBindPoint::eGraphics, pipeline );
+    command_buffer.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, *Vulkan.PipelineLayout, 0, { descriptor_set }, {} );
+
+    vk::Viewport viewport(
+      0.0f,                                                 // float                                  x
+      0.0f,                                                 // float                                  y
+      ImGui::GetIO().DisplaySize.x,                         // float                                  width
+      ImGui::GetIO().DisplaySize.y,                         // float                                  height
+      0.0f,                                                 // float                                  minDepth
+      1.0f                                                  // float                                  maxDepth
+    );
+    command_buffer.setViewport( 0, { viewport } );
+  }
+
+  void GUI::DrawOverlay( vk::CommandBuffer & command_buffer ) {
+    BindPipeline( command_buffer, *Vulkan.CompositePipeline, *Vulkan.OverlayDescriptorSet.Handle );
+
+    vk::Rect2D scissor(
+      vk::Offset2D(),                                       // VkOffset2D                             offset
+      Parent.GetSwapChain().Extent                          // VkExtent2D                             extent
+    );
+    command_buffer.setScissor( 0, { scissor } );
+
+    // Quad is defined in a <0, 1> range
+    std::vector<float> scale_and_translation = {
+      2.0f,                                                 // X scale
+      2.0f,                                                 // Y scale
+      -1.0f,                                                // X translation
+      -1.0f                                                 // Y translation
+    };
+    command_buffer.pushConstants( *Vulkan.PipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof( float ) * static_cast<uint32_t>(scale_and_translation.size()), scale_and_translation.data() );
+
+    command_buffer.bindVertexBuffers( 0, { *Vulkan.QuadBuffer.Handle }, { 0 } );
+    command_buffer.bindIndexBuffer( *Vulkan.QuadBuffer.Handle, 4 * sizeof( ImDrawVert ), vk::IndexType::eUint16 );
+    command_buffer.drawIndexed( 6, 1, 0, 0, 0 );
+  }
+
+  uint64_t GUI::CalculateDrawDataHash() const {
+    // FNV-1a hash of all the data influencing GUI's appearance
+    uint64_t hash = 14695981039346656037ull;
+    auto add_to_hash = [&hash]( void const * data, size_t size ) {
+      unsigned char const * bytes = reinterpret_cast<unsigned char const *>(data);
+      for( size_t i = 0; i < size; ++i ) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+      }
+    };
 
+    ImDrawData* draw_data = ImGui::GetDrawData();
+    for( int list = 0; list < draw_data->CmdListsCount; list++ ) {
+      const ImDrawList* cmd_list = draw_data->CmdLists[list];
+      add_to_hash( cmd_list->VtxBuffer.Data, sizeof( ImDrawVert ) * cmd_list->VtxBuffer.Size );
+      add_to_hash( cmd_list->IdxBuffer.Data, sizeof( ImDrawIdx ) * cmd_list->IdxBuffer.Size );
+      for( int command_index = 0; command_index < cmd_list->CmdBuffer.Size; command_index++ ) {
+        const ImDrawCmd* draw_command = &cmd_list->CmdBuffer[command_index];
+        add_to_hash( &draw_command->ClipRect, sizeof( draw_command->ClipRect ) );
+        add_to_hash( &draw_command->ElemCount, sizeof( draw_command->ElemCount ) );
+      }
+    }
+    return hash;
+  }
+
+  void GUI::DrawFrameData( vk::CommandBuffer & command_buffer, GUIResources::DrawDataParameters &drawing_resources ) {
     ImDrawData* draw_data = ImGui::GetDrawData();
 
     if( draw_data->TotalVtxCount == 0 ) {
+      StreamedBytes = 0;
       return;
     }
 
-    // Check if vertex buffer is created or if it is too small and needs to be re-created
+    // Check if buffer is created or if it is too small and needs to be re-created
+    uint32_t vertex_data_size = sizeof( ImDrawVert ) * draw_data->TotalVtxCount;
+    uint32_t index_data_size = sizeof( ImDrawIdx ) * draw_data->TotalIdxCount;
     {
-      uint32_t vertex_buffer_size = sizeof( ImDrawVert ) * draw_data->TotalVtxCount;
-      if( (!drawing_resources.VertexBuffer.Buffer.Handle) ||
-        (drawing_resources.VertexBuffer.Buffer.Size < vertex_buffer_size) ) {
-        drawing_resources.VertexBuffer.Buffer = Parent.CreateBuffer( vertex_buffer_size, vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eHostVisible );
-        drawing_resources.VertexBuffer.Pointer = Parent.GetDevice().mapMemory( *drawing_resources.VertexBuffer.Buffer.Memory, 0, vertex_buffer_size );
-      }
-    }
-    // Check if index buffer is created or if it is too small and needs to be re-created
-    {
-      uint32_t index_buffer_size = sizeof( ImDrawIdx ) * draw_data->TotalIdxCount;
-      if( (!drawing_resources.IndexBuffer.Buffer.Handle) ||
-        (drawing_resources.IndexBuffer.Buffer.Size < index_buffer_size) ) {
-        drawing_resources.IndexBuffer.Buffer = Parent.CreateBuffer( index_buffer_size, vk::BufferUsageFlagBits::eIndexBuffer, vk::MemoryPropertyFlagBits::eHostVisible );
-        drawing_resources.IndexBuffer.Pointer = Parent.GetDevice().mapMemory( *drawing_resources.IndexBuffer.Buffer.Memory, 0, index_buffer_size );
+      uint32_t index_offset = (vertex_data_size + 3) & ~3u;
+      if( (!drawing_resources.Buffer.Buffer.Handle) ||
+          (drawing_resources.Buffer.Buffer.Size < index_offset + index_data_size) ) {
+        ResizeDrawDataBuffer( drawing_resources, index_offset + index_data_size );
       }
+      drawing_resources.IndexOffset = index_offset;
     }
     // Upload vertex and index data
     {
-      ImDrawVert *vertex_memory_pointer = reinterpret_cast<ImDrawVert*>(drawing_resources.VertexBuffer.Pointer);
-      ImDrawIdx *index_memory_pointer = reinterpret_cast<ImDrawIdx*>(drawing_resources.IndexBuffer.Pointer);
+      ImDrawVert *vertex_memory_pointer = reinterpret_cast<ImDrawVert*>(drawing_resources.Buffer.Pointer);
+      ImDrawIdx *index_memory_pointer = reinterpret_cast<ImDrawIdx*>(reinterpret_cast<char*>(drawing_resources.Buffer.Pointer) + drawing_resources.IndexOffset);
 
       for( int i = 0; i < draw_data->CmdListsCount; i++ ) {
         const ImDrawList* cmd_list = draw_data->CmdLists[i];
@@ -175,24 +310,22 @@ namespace ApiWithoutSecrets {
         index_memory_pointer += cmd_list->IdxBuffer.Size;
       }
 
-      std::vector<vk::MappedMemoryRange> memory_ranges = {
-        {
-          *drawing_resources.VertexBuffer.Buffer.Memory,  // VkDeviceMemory             memory
-          0,                                              // VkDeviceSize               offset
-          VK_WHOLE_SIZE                                   // VkDeviceSize               size
-        },
-        {
-          *drawing_resources.IndexBuffer.Buffer.Memory,   // VkDeviceMemory             memory
+      // Host-coherent memory doesn't need to be flushed
+      if( !drawing_resources.HostCoherent ) {
+        vk::MappedMemoryRange memory_range(
+          *drawing_resources.Buffer.Buffer.Memory,        // VkDeviceMemory             memory
           0,                                              // VkDeviceSize               offset
           VK_WHOLE_SIZE                                   // VkDeviceSize               size
-        }
-      };
-      Parent.GetDevice().flushMappedMemoryRanges( memory_ranges );
+        );
+        Parent.GetDevice().flushMappedMemoryRanges( { memory_range } );
+      }
+
+      StreamedBytes = vertex_data_size + index_data_size;
     }
     // Bind vertex and index buffers
     {
-      command_buffer.bindVertexBuffers( 0, { *drawing_resources.VertexBuffer.Buffer.Handle }, { 0 } );
-      command_buffer.bindIndexBuffer( *drawing_resources.IndexBuffer.Buffer.Handle, 0, vk::IndexType::eUint16 );
+      command_buffer.bindVertexBuffers( 0, { *drawing_resources.Buffer.Buffer.Handle }, { 0 } );
+      command_buffer.bindIndexBuffer( *drawing_resources.Buffer.Buffer.Handle, drawing_resources.IndexOffset, vk::IndexType::eUint16 );
     }
     // Setup scale and translation:
     {
@@ -233,6 +366,31 @@ namespace ApiWithoutSecrets {
     }
   }
 
+  void GUI::ResizeDrawDataBuffer( GUIResources::DrawDataParameters & drawing_resources, uint32_t required_size ) {
+    // Grow geometrically so the buffer doesn't need to be re-created every time GUI gets slightly more complex
+    uint32_t new_size = std::max( required_size, 2 * drawing_resources.Buffer.Buffer.Size );
+
+    // Buffer is not used anymore - frame resources' fence was already waited on
+    if( drawing_resources.Buffer.Buffer.Memory ) {
+      Parent.GetDevice().unmapMemory( *drawing_resources.Buffer.Buffer.Memory );
+      drawing_resources.Buffer.Pointer = nullptr;
+    }
+
+    vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer;
+    try {
+      drawing_resources.Buffer.Buffer = Parent.CreateBuffer( new_size, usage, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent );
+      drawing_resources.HostCoherent = true;
+    } catch( ... ) {
+      drawing_resources.Buffer.Buffer = Parent.CreateBuffer( new_size, usage, vk::MemoryPropertyFlagBits::eHostVisible );
+      drawing_resources.HostCoherent = false;
+    }
+    drawing_resources.Buffer.Pointer = Parent.GetDevice().mapMemory( *drawing_resources.Buffer.Buffer.Memory, 0, VK_WHOLE_SIZE );
+  }
+
+  uint32_t GUI::GetStreamedBytes() const {
+    return StreamedBytes;
+  }
+
   void GUI::CreateTexture() {
     uint32_t width = 0;
     uint32_t height = 0;
@@ -296,6 +454,76 @@ namespace ApiWithoutSecrets {
     }
   }
 
+  void GUI::CreateOverlayResources( uint32_t width, uint32_t height ) {
+    // Quad covering the whole screen, drawn with a white color so overlay is not tinted
+    {
+      std::vector<ImDrawVert> vertices = {
+        { ImVec2( 0.0f, 0.0f ), ImVec2( 0.0f, 0.0f ), 0xFFFFFFFF },
+        { ImVec2( 1.0f, 0.0f ), ImVec2( 1.0f, 0.0f ), 0xFFFFFFFF },
+        { ImVec2( 1.0f, 1.0f ), ImVec2( 1.0f, 1.0f ), 0xFFFFFFFF },
+        { ImVec2( 0.0f, 1.0f ), ImVec2( 0.0f, 1.0f ), 0xFFFFFFFF }
+      };
+      std::vector<ImDrawIdx> indices = {
+        0, 1, 2, 0, 2, 3
+      };
+
+      std::vector<char> data( sizeof( ImDrawVert ) * vertices.size() + sizeof( ImDrawIdx ) * indices.size() );
+      memcpy( &data[0], vertices.data(), sizeof( ImDrawVert ) * vertices.size() );
+      memcpy( &data[sizeof( ImDrawVert ) * vertices.size()], indices.data(), sizeof( ImDrawIdx ) * indices.size() );
+
+      Vulkan.QuadBuffer = Parent.CreateBuffer( static_cast<uint32_t>(data.size()), vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal );
+      Parent.CopyDataToBuffer( static_cast<uint32_t>(data.size()), data.data(), *Vulkan.QuadBuffer.Handle, 0, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead, vk::PipelineStageFlagBits::eVertexInput );
+    }
+
+    CreateOverlayImage( width, height );
+  }
+
+  void GUI::CreateOverlayImage( uint32_t width, uint32_t height ) {
+    OverlayValid = false;
+
+    // Previous overlay resources may still be used by frames in flight so they are released later
+    Parent.DeferDestruction( std::move( Vulkan.OverlayFramebuffer ) );
+    Parent.DeferDestruction( std::move( Vulkan.OverlayDescriptorSet ) );
+    Parent.DeferDestruction( std::move( Vulkan.OverlayImage ) );
+
+    if( (width == 0) ||
+        (height == 0) ) {
+      return;
+    }
+
+    Vulkan.OverlayImage = Parent.CreateImage( width, height, OverlayFormat, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eColor );
+    Vulkan.OverlayImage.Sampler = Parent.CreateSampler( vk::SamplerMipmapMode::eNearest, vk::SamplerAddressMode::eClampToEdge, VK_FALSE );
+    Vulkan.OverlayFramebuffer = Parent.CreateFramebuffer( { *Vulkan.OverlayImage.View }, { width, height }, *Vulkan.OverlayRenderPass );
+
+    // Descriptor set for reading the overlay image is created anew as the previous one may still be in use
+    {
+      std::vector<vk::DescriptorSetLayoutBinding> layout_bindings = {
+        {
+          0,                                                  // uint32_t                             binding
+          vk::DescriptorType::eCombinedImageSampler,          // VkDescriptorType                     descriptorType
+          1,                                                  // uint32_t                             descriptorCount
+          vk::ShaderStageFlagBits::eFragment                  // VkShaderStageFlags                   stageFlags
+        }
+      };
+      std::vector<vk::DescriptorPoolSize> pool_sizes = {
+        {
+          vk::DescriptorType::eCombinedImageSampler,          // VkDescriptorType                     type
+          1                                                   // uint32_t                             descriptorCount
+        }
+      };
+      Vulkan.OverlayDescriptorSet = Parent.CreateDescriptorResources( layout_bindings, pool_sizes );
+    }
+
+    std::vector<vk::DescriptorImageInfo> image_infos = {
+      {
+        *Vulkan.OverlayImage.Sampler,                       // VkSampler                      sampler
+        *Vulkan.OverlayImage.View,                          // VkImageView                    imageView
+        vk::ImageLayout::eShaderReadOnlyOptimal             // VkImageLayout                  imageLayout
+      }
+    };
+    Parent.UpdateDescriptorSet( *Vulkan.OverlayDescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, 0, 0, image_infos );
+  }
+
   void GUI::CreatePipelineLayout() {
     vk::PushConstantRange range(
       vk::ShaderStageFlagBits::eVertex,               // VkShaderStageFlags             stageFlags
@@ -306,6 +534,169 @@ namespace ApiWithoutSecrets {
   }
 
   void GUI::CreateGraphicsPipeline() {
+    vk::UniqueRenderPass render_pass;
+    {
+      std::vector<RenderPassAttachmentData> attachment_descriptions = {
+        {
+          Parent.GetSwapChain().Format,                             // VkFormat                       format
+          vk::AttachmentLoadOp::eLoad,                              // VkAttachmentLoadOp             loadOp
+          vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
+          vk::ImageLayout::eColorAttachmentOptimal,                 // VkImageLayout                  initialLayout
+          vk::ImageLayout::ePresentSrcKHR                           // VkImageLayout                  finalLayout
+        },
+        {
+          SampleCommon::DefaultDepthFormat,                         // VkFormat                       format
+          vk::AttachmentLoadOp::eDontCare,                          // VkAttachmentLoadOp             loadOp
+          vk::AttachmentStoreOp::eDontCare,                         // VkAttachmentStoreOp            storeOp
+          vk::ImageLayout::eDepthStencilAttachmentOptimal,          // VkImageLayout                  initialLayout
+          vk::ImageLayout::eDepthStencilAttachmentOptimal           // VkImageLayout                  finalLayout
+        }
+      };
+
+      std::vector<RenderPassSubpassData> subpass_descriptions = {
+        {
+          {},                                                       // std::vector<VkAttachmentReference> const  &InputAttachments
+          {                                                         // std::vector<VkAttachmentReference> const  &ColorAttachments
+            {
+              0,                                                      // uint32_t                                   attachment
+              vk::ImageLayout::eColorAttachmentOptimal                // VkImageLayout                              layout
+            }
+          },
+          {                                                         // VkAttachmentReference const               &DepthStencilAttachment;
+            1,                                                        // uint32_t                                   attachment
+            vk::ImageLayout::eDepthStencilAttachmentOptimal           // VkImageLayout                              layout
+          }
+        }
+      };
+
+      std::vector<vk::SubpassDependency> dependencies = {
+        {
+          VK_SUBPASS_EXTERNAL,                                      // uint32_t                       srcSubpass
+          0,                                                        // uint32_t                       dstSubpass
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           srcStageMask
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           dstStageMask
+          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  srcAccessMask
+          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  dstAccessMask
+          vk::DependencyFlagBits::eByRegion                         // VkDependencyFlags              dependencyFlags
+        },
+        {
+          0,                                                        // uint32_t                       srcSubpass
+          VK_SUBPASS_EXTERNAL,                                      // uint32_t                       dstSubpass
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           srcStageMask
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           dstStageMask
+          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  srcAccessMask
+          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  dstAccessMask
+          vk::DependencyFlagBits::eByRegion                         // VkDependencyFlags              dependencyFlags
+        }
+      };
+      render_pass = Parent.CreateRenderPass( attachment_descriptions, subpass_descriptions, dependencies );
+    }
+    // Pipeline drawing GUI directly on top of a scene
+    {
+      vk::PipelineColorBlendAttachmentState color_blend_attachment_state(
+        VK_TRUE,                                                      // VkBool32                                       blendEnable
+        vk::BlendFactor::eSrcAlpha,                                   // VkBlendFactor                                  srcColorBlendFactor
+        vk::BlendFactor::eOneMinusSrcAlpha,                           // VkBlendFactor                                  dstColorBlendFactor
+        vk::BlendOp::eAdd,                                            // VkBlendOp                                      colorBlendOp
+        vk::BlendFactor::eOne,                                        // VkBlendFactor                                  srcAlphaBlendFactor
+        vk::BlendFactor::eZero,                                       // VkBlendFactor                                  dstAlphaBlendFactor
+        vk::BlendOp::eAdd,                                            // VkBlendOp                                      alphaBlendOp
+        vk::ColorComponentFlagBits::eR |                              // VkColorComponentFlags                          colorWriteMask
+        vk::ColorComponentFlagBits::eG |
+        vk::ColorComponentFlagBits::eB |
+        vk::ColorComponentFlagBits::eA
+      );
+
+      Vulkan.GraphicsPipeline = CreatePipeline( *render_pass, color_blend_attachment_state );
+    }
+    // Pipeline drawing GUI into a cached overlay image; overlay stores premultiplied color and GUI coverage in alpha
+    {
+      std::vector<RenderPassAttachmentData> attachment_descriptions = {
+        {
+          OverlayFormat,                                            // VkFormat                       format
+          vk::AttachmentLoadOp::eClear,                             // VkAttachmentLoadOp             loadOp
+          vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
+          vk::ImageLayout::eUndefined,                              // VkImageLayout                  initialLayout
+          vk::ImageLayout::eShaderReadOnlyOptimal                   // VkImageLayout                  finalLayout
+        }
+      };
+
+      std::vector<RenderPassSubpassData> subpass_descriptions = {
+        {
+          {},                                                       // std::vector<VkAttachmentReference> const  &InputAttachments
+          {                                                         // std::vector<VkAttachmentReference> const  &ColorAttachments
+            {
+              0,                                                      // uint32_t                                   attachment
+              vk::ImageLayout::eColorAttachmentOptimal                // VkImageLayout                              layout
+            }
+          },
+          {                                                         // VkAttachmentReference const               &DepthStencilAttachment;
+            VK_ATTACHMENT_UNUSED,                                     // uint32_t                                   attachment
+            vk::ImageLayout::eUndefined                               // VkImageLayout                              layout
+          }
+        }
+      };
+
+      // Overlay image may still be read by previously submitted frames
+      std::vector<vk::SubpassDependency> dependencies = {
+        {
+          VK_SUBPASS_EXTERNAL,                                      // uint32_t                       srcSubpass
+          0,                                                        // uint32_t                       dstSubpass
+          vk::PipelineStageFlagBits::eFragmentShader,               // VkPipelineStageFlags           srcStageMask
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           dstStageMask
+          vk::AccessFlagBits::eShaderRead,                          // VkAccessFlags                  srcAccessMask
+          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  dstAccessMask
+          vk::DependencyFlagBits::eByRegion                         // VkDependencyFlags              dependencyFlags
+        },
+        {
+          0,                                                        // uint32_t                       srcSubpass
+          VK_SUBPASS_EXTERNAL,                                      // uint32_t                       dstSubpass
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           srcStageMask
+          vk::PipelineStageFlagBits::eFragmentShader,               // VkPipelineStageFlags           dstStageMask
+          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  srcAccessMask
+          vk::AccessFlagBits::eShaderRead,                          // VkAccessFlags                  dstAccessMask
+          vk::DependencyFlagBits::eByRegion                         // VkDependencyFlags              dependencyFlags
+        }
+      };
+      Vulkan.OverlayRenderPass = Parent.CreateRenderPass( attachment_descriptions, subpass_descriptions, dependencies );
+
+      vk::PipelineColorBlendAttachmentState overlay_blend_attachment_state(
+        VK_TRUE,                                                      // VkBool32                                       blendEnable
+        vk::BlendFactor::eSrcAlpha,                                   // VkBlendFactor                                  srcColorBlendFactor
+        vk::BlendFactor::eOneMinusSrcAlpha,                           // VkBlendFactor                                  dstColorBlendFactor
+        vk::BlendOp::eAdd,                                            // VkBlendOp                                      colorBlendOp
+        vk::BlendFactor::eOne,                                        // VkBlendFactor                                  srcAlphaBlendFactor
+        vk::BlendFactor::eOneMinusSrcAlpha,                           // VkBlendFactor                                  dstAlphaBlendFactor
+        vk::BlendOp::eAdd,                                            // VkBlendOp                                      alphaBlendOp
+        vk::ColorComponentFlagBits::eR |                              // VkColorComponentFlags                          colorWriteMask
+        vk::ColorComponentFlagBits::eG |
+        vk::ColorComponentFlagBits::eB |
+        vk::ColorComponentFlagBits::eA
+      );
+
+      Vulkan.OverlayPipeline = CreatePipeline( *Vulkan.OverlayRenderPass, overlay_blend_attachment_state );
+    }
+    // Pipeline compositing the cached overlay on top of a scene
+    {
+      vk::PipelineColorBlendAttachmentState composite_blend_attachment_state(
+        VK_TRUE,                                                      // VkBool32                                       blendEnable
+        vk::BlendFactor::eOne,                                        // VkBlendFactor                                  srcColorBlendFactor
+        vk::BlendFactor::eOneMinusSrcAlpha,                           // VkBlendFactor                                  dstColorBlendFactor
+        vk::BlendOp::eAdd,                                            // VkBlendOp                                      colorBlendOp
+        vk::BlendFactor::eZero,                                       // VkBlendFactor                                  srcAlphaBlendFactor
+        vk::BlendFactor::eOne,                                        // VkBlendFactor                                  dstAlphaBlendFactor
+        vk::BlendOp::eAdd,                                            // VkBlendOp                                      alphaBlendOp
+        vk::ColorComponentFlagBits::eR |                              // VkColorComponentFlags                          colorWriteMask
+        vk::ColorComponentFlagBits::eG |
+        vk::ColorComponentFlagBits::eB |
+        vk::ColorComponentFlagBits::eA
+      );
+
+      Vulkan.CompositePipeline = CreatePipeline( *render_pass, composite_blend_attachment_state );
+    }
+  }
+
+  vk::UniquePipeline GUI::CreatePipeline( vk::RenderPass const & render_pass, vk::PipelineColorBlendAttachmentState const & color_blend_attachment_state ) const {
     vk::UniqueShaderModule vertex_shader_module = Parent.CreateShaderModule( "Data/Common/gui.vert.spv" );
     vk::UniqueShaderModule fragment_shader_module = Parent.CreateShaderModule( "Data/Common/gui.frag.spv" );
 
@@ -407,20 +798,6 @@ namespace ApiWithoutSecrets {
       vk::CompareOp::eAlways                                        // VkCompareOp                                    depthCompareOp
     );
 
-    vk::PipelineColorBlendAttachmentState color_blend_attachment_state(
-      VK_TRUE,                                                      // VkBool32                                       blendEnable
-      vk::BlendFactor::eSrcAlpha,                                   // VkBlendFactor                                  srcColorBlendFactor
-      vk::BlendFactor::eOneMinusSrcAlpha,                           // VkBlendFactor                                  dstColorBlendFactor
-      vk::BlendOp::eAdd,                                            // VkBlendOp                                      colorBlendOp
-      vk::BlendFactor::eOne,                                        // VkBlendFactor                                  srcAlphaBlendFactor
-      vk::BlendFactor::eZero,                                       // VkBlendFactor                                  dstAlphaBlendFactor
-      vk::BlendOp::eAdd,                                            // VkBlendOp                                      alphaBlendOp
-      vk::ColorComponentFlagBits::eR |                              // VkColorComponentFlags                          colorWriteMask
-      vk::ColorComponentFlagBits::eG |
-      vk::ColorComponentFlagBits::eB |
-      vk::ColorComponentFlagBits::eA
-    );
-
     vk::PipelineColorBlendStateCreateInfo color_blend_state_create_info(
       vk::PipelineColorBlendStateCreateFlags( 0 ),                  // VkPipelineColorBlendStateCreateFlags           flags
       VK_FALSE,                                                     // VkBool32                                       logicOpEnable
@@ -440,64 +817,6 @@ namespace ApiWithoutSecrets {
       dynamic_states.data()                                         // const VkDynamicState                          *pDynamicStates
     );
 
-    vk::UniqueRenderPass render_pass;
-    {
-      std::vector<RenderPassAttachmentData> attachment_descriptions = {
-        {
-          Parent.GetSwapChain().Format,                             // VkFormat                       format
-          vk::AttachmentLoadOp::eLoad,                              // VkAttachmentLoadOp             loadOp
-          vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
-          vk::ImageLayout::eColorAttachmentOptimal,                 // VkImageLayout                  initialLayout
-          vk::ImageLayout::ePresentSrcKHR                           // VkImageLayout                  finalLayout
-        },
-        {
-          SampleCommon::DefaultDepthFormat,                         // VkFormat                       format
-          vk::AttachmentLoadOp::eDontCare,                          // VkAttachmentLoadOp             loadOp
-          vk::AttachmentStoreOp::eDontCare,                         // VkAttachmentStoreOp            storeOp
-          vk::ImageLayout::eDepthStencilAttachmentOptimal,          // VkImageLayout                  initialLayout
-          vk::ImageLayout::eDepthStencilAttachmentOptimal           // VkImageLayout                  finalLayout
-        }
-      };
-
-      std::vector<RenderPassSubpassData> subpass_descriptions = {
-        {
-          {},                                                       // std::vector<VkAttachmentReference> const  &InputAttachments
-          {                                                         // std::vector<VkAttachmentReference> const  &ColorAttachments
-            {
-              0,                                                      // uint32_t                                   attachment
-              vk::ImageLayout::eColorAttachmentOptimal                // VkImageLayout                              layout
-            }
-          },
-          {                                                         // VkAttachmentReference const               &DepthStencilAttachment;
-            1,                                                        // uint32_t                                   attachment
-            vk::ImageLayout::eDepthStencilAttachmentOptimal           // VkImageLayout                              layout
-          }
-        }
-      };
-
-      std::vector<vk::SubpassDependency> dependencies = {
-        {
-          VK_SUBPASS_EXTERNAL,                                      // uint32_t                       srcSubpass
-          0,                                                        // uint32_t                       dstSubpass
-          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           srcStageMask
-          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           dstStageMask
-          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  srcAccessMask
-          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  dstAccessMask
-          vk::DependencyFlagBits::eByRegion                         // VkDependencyFlags              dependencyFlags
-        },
-        {
-          0,                                                        // uint32_t                       srcSubpass
-          VK_SUBPASS_EXTERNAL,                                      // uint32_t                       dstSubpass
-          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           srcStageMask
-          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           dstStageMask
-          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  srcAccessMask
-          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  dstAccessMask
-          vk::DependencyFlagBits::eByRegion                         // VkDependencyFlags              dependencyFlags
-        }
-      };
-      render_pass = Parent.CreateRenderPass( attachment_descriptions, subpass_descriptions, dependencies );
-    }
-
     vk::GraphicsPipelineCreateInfo pipeline_create_info(
       vk::PipelineCreateFlags( 0 ),                                 // VkPipelineCreateFlags                          flags
       static_cast<uint32_t>(shader_stage_create_infos.size()),      // uint32_t                                       stageCount
@@ -512,12 +831,12 @@ namespace ApiWithoutSecrets {
       &color_blend_state_create_info,                               // const VkPipelineColorBlendStateCreateInfo     *pColorBlendState
       &dynamic_state_create_info,                                   // const VkPipelineDynamicStateCreateInfo        *pDynamicState
       *Vulkan.PipelineLayout,                                       // VkPipelineLayout                               layout
-      *render_pass,                                                 // VkRenderPass                                   renderPass
+      render_pass,                                                  // VkRenderPass                                   renderPass
       0,                                                            // uint32_t                                       subpass
       vk::Pipeline(),                                               // VkPipeline                                     basePipelineHandle
       -1                                                            // int32_t                                        basePipelineIndex
     );
-    Vulkan.GraphicsPipeline = Parent.GetDevice().createGraphicsPipelineUnique( vk::PipelineCache(), pipeline_create_info );
+    return Parent.GetDevice().createGraphicsPipelineUnique( vk::PipelineCache(), pipeline_create_info );
   }
 
   GUI::~GUI() {
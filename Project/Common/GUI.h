@@ -30,12 +30,14 @@ namespace ApiWithoutSecrets {
   // ************************************************************ //
   struct GUIResources {
     struct DrawDataParameters {
-      StagingBufferParameters             VertexBuffer;
-      StagingBufferParameters             IndexBuffer;
+      StagingBufferParameters             Buffer;             // <- Persistently mapped; vertices first, indices at IndexOffset
+      bool                                HostCoherent;
+      uint32_t                            IndexOffset;
 
       DrawDataParameters() :
-        VertexBuffer(),
-        IndexBuffer() {
+        Buffer(),
+        HostCoherent( false ),
+        IndexOffset( 0 ) {
       }
     };
 
@@ -44,13 +46,27 @@ namespace ApiWithoutSecrets {
     vk::UniquePipelineLayout              PipelineLayout;
     vk::UniquePipeline                    GraphicsPipeline;
     std::vector<DrawDataParameters>       DrawingResources;
+    vk::UniqueRenderPass                  OverlayRenderPass;
+    vk::UniquePipeline                    OverlayPipeline;
+    vk::UniquePipeline                    CompositePipeline;
+    ImageParameters                       OverlayImage;
+    vk::UniqueFramebuffer                 OverlayFramebuffer;
+    DescriptorSetParameters               OverlayDescriptorSet;
+    BufferParameters                      QuadBuffer;
 
     GUIResources() :
       Image(),
       DescriptorSet(),
       PipelineLayout(),
       GraphicsPipeline(),
-      DrawingResources() {
+      DrawingResources(),
+      OverlayRenderPass(),
+      OverlayPipeline(),
+      CompositePipeline(),
+      OverlayImage(),
+      OverlayFramebuffer(),
+      OverlayDescriptorSet(),
+      QuadBuffer() {
     }
   };
 
@@ -69,16 +85,34 @@ namespace ApiWithoutSecrets {
 
     void              StartFrame( TimerData const & timer, OS::ProjectBase::MouseInputStateData & mouse_state );
     void              Draw( uint32_t resource_index, vk::CommandBuffer & command_buffer, vk::RenderPass const & render_pass, vk::Framebuffer const & framebuffer );
+    void              SkipFrame();
+
+    uint32_t          GetStreamedBytes() const;
 
   private:
+    static const vk::Format OverlayFormat = vk::Format::eR8G8B8A8Unorm;
+
     const SampleCommon  & Parent;
     GUIResources          Vulkan;
+    uint32_t              StreamedBytes;
+    bool                  CacheOverlay;
+    int                   OverlayUpdateInterval;
+    int                   FramesSinceOverlayUpdate;
+    bool                  OverlayValid;
+    uint64_t              DrawDataHash;
 
     void              DrawFrameData( vk::CommandBuffer & command_buffer, GUIResources::DrawDataParameters & drawing_resources );
+    void              ResizeDrawDataBuffer( GUIResources::DrawDataParameters & drawing_resources, uint32_t required_size );
+    void              BindPipeline( vk::CommandBuffer & command_buffer, vk::Pipeline const & pipeline, vk::DescriptorSet const & descriptor_set );
+    void              DrawOverlay( vk::CommandBuffer & command_buffer );
+    uint64_t          CalculateDrawDataHash() const;
     void              CreateTexture();
     void              CreateDescriptorResources();
+    void              CreateOverlayResources( uint32_t width, uint32_t height );
+    void              CreateOverlayImage( uint32_t width, uint32_t height );
     void              CreatePipelineLayout();
     void              CreateGraphicsPipeline();
+    vk::UniquePipeline  CreatePipeline( vk::RenderPass const & render_pass, vk::PipelineColorBlendAttachmentState const & color_blend_attachment_state ) const;
   };
 
 } // namespace ApiWithoutSecrets
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "GeometryArena.h"
+
+namespace ApiWithoutSecrets {
+
+  GeometryArena::GeometryArena( uint32_t vertex_stride ) :
+    VertexStride( vertex_stride ),
+    VertexData(),
+    IndexData(),
+    Meshes() {
+  }
+
+  uint32_t GeometryArena::AddMesh( void const * vertices, uint32_t vertices_count, std::vector<uint32_t> const & indices ) {
+    GeometryMeshRange mesh;
+    mesh.FirstIndex = static_cast<uint32_t>(IndexData.size());
+    mesh.IndexCount = static_cast<uint32_t>(indices.size());
+    mesh.VertexOffset = static_cast<int32_t>(VertexData.size() / VertexStride);
+    mesh.VertexCount = vertices_count;
+
+    size_t vertex_data_size = VertexData.size();
+    VertexData.resize( vertex_data_size + vertices_count * VertexStride );
+    std::memcpy( &VertexData[vertex_data_size], vertices, vertices_count * VertexStride );
+    IndexData.insert( IndexData.end(), indices.begin(), indices.end() );
+
+    Meshes.push_back( mesh );
+    return static_cast<uint32_t>(Meshes.size() - 1);
+  }
+
+  void GeometryArena::Clear() {
+    VertexData.clear();
+    IndexData.clear();
+    Meshes.clear();
+  }
+
+  uint32_t GeometryArena::GetVertexStride() const {
+    return VertexStride;
+  }
+
+  std::vector<uint8_t> const & GeometryArena::GetVertexData() const {
+    return VertexData;
+  }
+
+  std::vector<uint32_t> const & GeometryArena::GetIndexData() const {
+    return IndexData;
+  }
+
+  std::vector<GeometryMeshRange> const & GeometryArena::GetMeshes() const {
+    return Meshes;
+  }
+
+  vk::DeviceSize GeometryArena::GetIndexOffset() const {
+    // Index buffer binding offset must be a multiple of an index size
+    return (VertexData.size() + IndexDataAlignment - 1) / IndexDataAlignment * IndexDataAlignment;
+  }
+
+  vk::DeviceSize GeometryArena::GetSize() const {
+    return GetIndexOffset() + IndexData.size() * sizeof( uint32_t );
+  }
+
+} // namespace ApiWithoutSecrets
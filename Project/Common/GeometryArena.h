@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(GEOMETRY_ARENA_HEADER)
+#define GEOMETRY_ARENA_HEADER
+
+#include <cstdint>
+#include <vector>
+#include "VulkanCommon.h"
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // GeometryMeshRange                                            //
+  //                                                              //
+  // Location of a single mesh inside a geometry arena; indices   //
+  // are relative to a mesh so they are offset by VertexOffset    //
+  // when drawn                                                   //
+  // ************************************************************ //
+  struct GeometryMeshRange {
+    uint32_t    FirstIndex;
+    uint32_t    IndexCount;
+    int32_t     VertexOffset;
+    uint32_t    VertexCount;
+
+    GeometryMeshRange() :
+      FirstIndex( 0 ),
+      IndexCount( 0 ),
+      VertexOffset( 0 ),
+      VertexCount( 0 ) {
+    }
+  };
+
+  // ************************************************************ //
+  // GeometryArenaParameters                                      //
+  //                                                              //
+  // Static meshes packed into a single buffer and allocation;    //
+  // vertices are stored first, followed by 32-bit indices        //
+  // ************************************************************ //
+  struct GeometryArenaParameters {
+    BufferParameters                Buffer;
+    vk::DeviceSize                  IndexOffset;
+    std::vector<GeometryMeshRange>  Meshes;
+
+    GeometryArenaParameters() :
+      Buffer(),
+      IndexOffset( 0 ),
+      Meshes() {
+    }
+  };
+
+  // ************************************************************ //
+  // GeometryArena                                                //
+  //                                                              //
+  // Collects vertices and indices of static meshes on the CPU,   //
+  // so all of them can be uploaded at once and drawn with a      //
+  // single vertex and index buffer binding                       //
+  // ************************************************************ //
+  class GeometryArena {
+  public:
+    static const vk::DeviceSize   IndexDataAlignment = 16;
+
+    explicit GeometryArena( uint32_t vertex_stride );
+
+    uint32_t                                AddMesh( void const * vertices, uint32_t vertices_count, std::vector<uint32_t> const & indices );
+    void                                    Clear();
+
+    uint32_t                                GetVertexStride() const;
+    std::vector<uint8_t> const            & GetVertexData() const;
+    std::vector<uint32_t> const           & GetIndexData() const;
+    std::vector<GeometryMeshRange> const  & GetMeshes() const;
+    vk::DeviceSize                          GetIndexOffset() const;
+    vk::DeviceSize                          GetSize() const;
+
+  private:
+    uint32_t                        VertexStride;
+    std::vector<uint8_t>            VertexData;
+    std::vector<uint32_t>           IndexData;
+    std::vector<GeometryMeshRange>  Meshes;
+  };
+
+} // namespace ApiWithoutSecrets
+
+#endif // GEOMETRY_ARENA_HEADER
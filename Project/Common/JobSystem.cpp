@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "JobSystem.h"
+
+namespace ApiWithoutSecrets {
+
+  namespace {
+    // Index of a queue owned by the current thread
+    thread_local uint32_t CurrentThreadIndex = 0;
+  }
+
+  WorkStealingQueue::WorkStealingQueue() :
+    Top( 0 ),
+    Bottom( 0 ) {
+    for( auto & job : Jobs ) {
+      job.store( nullptr, std::memory_order_relaxed );
+    }
+  }
+
+  bool WorkStealingQueue::Push( Job * job ) {
+    int64_t bottom = Bottom.load( std::memory_order_relaxed );
+    int64_t top = Top.load( std::memory_order_acquire );
+    if( bottom - top >= Capacity ) {
+      return false;
+    }
+    // Job must be visible before thieves can see a new bottom
+    Jobs[bottom & (Capacity - 1)].store( job, std::memory_order_release );
+    Bottom.store( bottom + 1, std::memory_order_release );
+    return true;
+  }
+
+  WorkStealingQueue::Job * WorkStealingQueue::Pop() {
+    int64_t bottom = Bottom.load( std::memory_order_relaxed ) - 1;
+    Bottom.store( bottom, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    int64_t top = Top.load( std::memory_order_relaxed );
+
+    if( top > bottom ) {
+      // Queue is empty
+      Bottom.store( bottom + 1, std::memory_order_relaxed );
+      return nullptr;
+    }
+    Job * job = Jobs[bottom & (Capacity - 1)].load( std::memory_order_relaxed );
+    if( top == bottom ) {
+      // Last job - thieves may compete for it
+      if( !Top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+        job = nullptr;
+      }
+      Bottom.store( bottom + 1, std::memory_order_relaxed );
+    }
+    return job;
+  }
+
+  WorkStealingQueue::Job * WorkStealingQueue::Steal() {
+    int64_t top = Top.load( std::memory_order_acquire );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    int64_t bottom = Bottom.load( std::memory_order_acquire );
+
+    if( top >= bottom ) {
+      return nullptr;
+    }
+    Job * job = Jobs[top & (Capacity - 1)].load( std::memory_order_acquire );
+    if( !Top.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) ) {
+      // Lost a race with the owner or another thief
+      return nullptr;
+    }
+    return job;
+  }
+
+  WorkStealingQueue::~WorkStealingQueue() {
+  }
+
+  JobSystem::JobSystem() :
+    Queues(),
+    Workers(),
+    StopRequested( false ),
+    PendingJobs( 0 ),
+    WakeMutex(),
+    JobAdded() {
+  }
+
+  void JobSystem::Start( uint32_t worker_count ) {
+    Stop();
+
+    CurrentThreadIndex = 0;
+    StopRequested = false;
+    for( uint32_t i = 0; i <= worker_count; ++i ) {
+      Queues.emplace_back( new WorkStealingQueue() );
+    }
+    // Workers are started after all queues are created as they steal from each other
+    for( uint32_t i = 1; i <= worker_count; ++i ) {
+      Workers.emplace_back( &JobSystem::WorkerLoop, this, i );
+    }
+  }
+
+  void JobSystem::Stop() {
+    StopRequested = true;
+    JobAdded.notify_all();
+    for( auto & worker : Workers ) {
+      worker.join();
+    }
+    Workers.clear();
+
+    // Jobs which were not executed are released
+    for( auto & queue : Queues ) {
+      while( WorkStealingQueue::Job * job = queue->Steal() ) {
+        delete job;
+      }
+    }
+    Queues.clear();
+    PendingJobs = 0;
+  }
+
+  bool JobSystem::IsStarted() const {
+    return !Queues.empty();
+  }
+
+  uint32_t JobSystem::GetThreadCount() const {
+    return Queues.empty() ? 1 : static_cast<uint32_t>(Queues.size());
+  }
+
+  uint32_t JobSystem::GetCurrentThreadIndex() const {
+    return CurrentThreadIndex;
+  }
+
+  void JobSystem::Submit( std::function<void()> function, JobCounter & counter ) {
+    counter.fetch_add( 1, std::memory_order_relaxed );
+
+    WorkStealingQueue::Job * job = new WorkStealingQueue::Job{ std::move( function ), &counter };
+    // Counter is increased before the job is published, so a thief which executes it right away can't underflow it
+    PendingJobs.fetch_add( 1, std::memory_order_release );
+    if( Queues.empty() || !Queues[CurrentThreadIndex]->Push( job ) ) {
+      // No workers or the queue is full
+      PendingJobs.fetch_sub( 1, std::memory_order_relaxed );
+      job->Function();
+      counter.fetch_sub( 1, std::memory_order_release );
+      delete job;
+      return;
+    }
+    JobAdded.notify_one();
+  }
+
+  void JobSystem::Wait( JobCounter const & counter ) {
+    // Waiting thread executes its own and stolen jobs instead of blocking
+    while( counter.load( std::memory_order_acquire ) > 0 ) {
+      if( !ExecuteJob( CurrentThreadIndex ) ) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  bool JobSystem::ExecuteJob( uint32_t thread_index ) {
+    if( Queues.empty() ) {
+      return false;
+    }
+
+    WorkStealingQueue::Job * job = Queues[thread_index]->Pop();
+    for( size_t i = 1; (job == nullptr) && (i < Queues.size()); ++i ) {
+      job = Queues[(thread_index + i) % Queues.size()]->Steal();
+    }
+    if( job == nullptr ) {
+      return false;
+    }
+
+    PendingJobs.fetch_sub( 1, std::memory_order_relaxed );
+    job->Function();
+    job->Counter->fetch_sub( 1, std::memory_order_release );
+    delete job;
+    return true;
+  }
+
+  void JobSystem::WorkerLoop( uint32_t thread_index ) {
+    CurrentThreadIndex = thread_index;
+
+    while( !StopRequested ) {
+      if( !ExecuteJob( thread_index ) ) {
+        // Notification is sent without a lock so a timeout guards against a missed wakeup
+        std::unique_lock<std::mutex> lock( WakeMutex );
+        JobAdded.wait_for( lock, std::chrono::milliseconds( 1 ), [this]() {
+          return StopRequested || (PendingJobs.load( std::memory_order_acquire ) > 0);
+        } );
+      }
+    }
+  }
+
+  JobSystem::~JobSystem() {
+    Stop();
+  }
+
+} // namespace ApiWithoutSecrets
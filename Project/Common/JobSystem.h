@@ -0,0 +1,105 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(JOB_SYSTEM_HEADER)
+#define JOB_SYSTEM_HEADER
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // JobCounter                                                   //
+  //                                                              //
+  // Number of submitted and not yet finished jobs of a group     //
+  // ************************************************************ //
+  typedef std::atomic<uint32_t> JobCounter;
+
+  // ************************************************************ //
+  // WorkStealingQueue                                            //
+  //                                                              //
+  // Fixed-size Chase-Lev deque; only the owning thread pushes    //
+  // and pops at the bottom, other threads steal from the top     //
+  // without locks                                                //
+  // ************************************************************ //
+  class WorkStealingQueue {
+  public:
+    struct Job {
+      std::function<void()>   Function;
+      JobCounter             *Counter;
+    };
+
+    static const int64_t  Capacity = 4096;
+
+    bool    Push( Job * job );
+    Job   * Pop();
+    Job   * Steal();
+
+    WorkStealingQueue();
+    ~WorkStealingQueue();
+
+  private:
+    std::atomic<int64_t>    Top;
+    std::atomic<int64_t>    Bottom;
+    std::atomic<Job*>       Jobs[Capacity];
+  };
+
+  // ************************************************************ //
+  // JobSystem                                                    //
+  //                                                              //
+  // Scheduler with a deque per thread; idle workers steal jobs   //
+  // from other threads, the thread which started the system      //
+  // participates in execution while it waits for a counter       //
+  // ************************************************************ //
+  class JobSystem {
+  public:
+    void      Start( uint32_t worker_count );
+    void      Stop();
+    bool      IsStarted() const;
+    uint32_t  GetThreadCount() const;
+    uint32_t  GetCurrentThreadIndex() const;
+
+    // Must be called from the thread which started the system or from a job;
+    // when the system is not started jobs are executed immediately
+    void      Submit( std::function<void()> function, JobCounter & counter );
+    void      Wait( JobCounter const & counter );
+
+    JobSystem();
+    ~JobSystem();
+
+  private:
+    std::vector<std::unique_ptr<WorkStealingQueue>> Queues;         // <- Queue 0 belongs to the thread which started the system
+    std::vector<std::thread>                        Workers;
+    std::atomic<bool>                               StopRequested;
+    std::atomic<uint32_t>                           PendingJobs;
+    std::mutex                                      WakeMutex;
+    std::condition_variable                         JobAdded;
+
+    bool      ExecuteJob( uint32_t thread_index );
+    void      WorkerLoop( uint32_t thread_index );
+  };
+
+} // namespace ApiWithoutSecrets
+
+#endif // JOB_SYSTEM_HEADER
@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include "LatencyMonitor.h"
+#include "VulkanFunctions.h"
+
+namespace ApiWithoutSecrets {
+
+  LatencyMonitor::LatencyMonitor() :
+    Device(),
+    Thread(),
+    StopRequested( false ),
+    PendingPresents(),
+    SwapChainGeneration( 0 ),
+    SwapChainMutex(),
+    PresentAdded(),
+    Samples(),
+    NextSample( 0 ),
+    SamplesMutex() {
+  }
+
+  void LatencyMonitor::Start( vk::Device device ) {
+    Stop();
+
+    Device = device;
+    StopRequested = false;
+    Thread = std::thread( &LatencyMonitor::WaitForPresents, this );
+  }
+
+  void LatencyMonitor::Stop() {
+    if( !Thread.joinable() ) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock( SwapChainMutex );
+      StopRequested = true;
+      PendingPresents.clear();
+    }
+    PresentAdded.notify_all();
+    Thread.join();
+  }
+
+  bool LatencyMonitor::IsPresentWaitUsed() const {
+    return Thread.joinable();
+  }
+
+  void LatencyMonitor::AddPresent( vk::SwapchainKHR swap_chain, uint64_t present_id, TimePoint input_time ) {
+    {
+      std::lock_guard<std::mutex> lock( SwapChainMutex );
+      PendingPresents.push_back( { swap_chain, present_id, input_time } );
+    }
+    PresentAdded.notify_one();
+  }
+
+  void LatencyMonitor::AddCompletion( TimePoint input_time, TimePoint completion_time ) {
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(completion_time - input_time);
+    float float_latency = static_cast<float>(latency.count() * 0.001f);
+
+    std::lock_guard<std::mutex> lock( SamplesMutex );
+    if( Samples.size() < MaxSamplesCount ) {
+      Samples.push_back( float_latency );
+    } else {
+      Samples[NextSample] = float_latency;
+    }
+    NextSample = (NextSample + 1) % MaxSamplesCount;
+  }
+
+  void LatencyMonitor::DiscardSwapChain( vk::SwapchainKHR swap_chain ) {
+    // Monitor thread waits only while holding the mutex, so after the lock is acquired it doesn't use the swapchain;
+    // new generation tells the monitor thread to drop a present it was waiting for between wait slices
+    std::lock_guard<std::mutex> lock( SwapChainMutex );
+    ++SwapChainGeneration;
+    PendingPresents.erase( std::remove_if( PendingPresents.begin(), PendingPresents.end(), [swap_chain]( PendingPresentData const & present ) {
+      return present.SwapChain == swap_chain;
+    } ), PendingPresents.end() );
+  }
+
+  std::mutex & LatencyMonitor::GetSwapChainMutex() {
+    return SwapChainMutex;
+  }
+
+  float LatencyMonitor::GetPercentile( float percentile ) const {
+    std::vector<float> samples;
+    {
+      std::lock_guard<std::mutex> lock( SamplesMutex );
+      samples = Samples;
+    }
+    if( samples.empty() ) {
+      return 0.0f;
+    }
+    size_t index = std::min( static_cast<size_t>(percentile * 0.01f * samples.size()), samples.size() - 1 );
+    std::nth_element( samples.begin(), samples.begin() + index, samples.end() );
+    return samples[index];
+  }
+
+  void LatencyMonitor::WaitForPresents() {
+    // Host access to a swapchain must be externally synchronized, so presentation is waited for in short slices
+    // which allows the rendering thread to acquire, present or recreate the swapchain in between
+    static const uint64_t wait_timeout = 1000000;
+
+    std::unique_lock<std::mutex> lock( SwapChainMutex );
+    while( !StopRequested ) {
+      if( PendingPresents.empty() ) {
+        PresentAdded.wait( lock );
+        continue;
+      }
+
+      PendingPresentData present = PendingPresents.front();
+      uint64_t generation = SwapChainGeneration;
+      VkResult result = vkWaitForPresentKHR( static_cast<VkDevice>(Device), static_cast<VkSwapchainKHR>(present.SwapChain), present.PresentId, wait_timeout );
+      while( (result == VK_TIMEOUT) && !StopRequested ) {
+        lock.unlock();
+        std::this_thread::yield();
+        lock.lock();
+        // Pending presents of a discarded swapchain were already removed, so the copied one is stale
+        if( generation != SwapChainGeneration ) {
+          break;
+        }
+        result = vkWaitForPresentKHR( static_cast<VkDevice>(Device), static_cast<VkSwapchainKHR>(present.SwapChain), present.PresentId, wait_timeout );
+      }
+      if( (generation != SwapChainGeneration) ||
+          (result == VK_TIMEOUT) ) {
+        continue;
+      }
+      if( result == VK_SUCCESS ) {
+        AddCompletion( present.InputTime, std::chrono::high_resolution_clock::now() );
+      }
+      // Presents which can't be waited for (i.e. when swapchain is out of date) are dropped
+      PendingPresents.pop_front();
+    }
+  }
+
+  LatencyMonitor::~LatencyMonitor() {
+    Stop();
+  }
+
+} // namespace ApiWithoutSecrets
@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(LATENCY_MONITOR_HEADER)
+#define LATENCY_MONITOR_HEADER
+
+#include <chrono>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "vulkan.hpp"
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // LatencyMonitor                                               //
+  //                                                              //
+  // Class collecting latencies between an input sample and the   //
+  // completion of a frame; with present wait a monitor thread    //
+  // timestamps presentation of each frame, otherwise completion  //
+  // times are provided by the caller                             //
+  // ************************************************************ //
+  class LatencyMonitor {
+  public:
+    static const size_t   MaxSamplesCount = 256;
+
+    typedef std::chrono::high_resolution_clock::time_point TimePoint;
+
+    void        Start( vk::Device device );
+    void        Stop();
+    bool        IsPresentWaitUsed() const;
+
+    void        AddPresent( vk::SwapchainKHR swap_chain, uint64_t present_id, TimePoint input_time );
+    void        AddCompletion( TimePoint input_time, TimePoint completion_time );
+    void        DiscardSwapChain( vk::SwapchainKHR swap_chain );
+    std::mutex& GetSwapChainMutex();
+
+    float       GetPercentile( float percentile ) const;
+
+    LatencyMonitor();
+    ~LatencyMonitor();
+
+  private:
+    struct PendingPresentData {
+      vk::SwapchainKHR    SwapChain;
+      uint64_t            PresentId;
+      TimePoint           InputTime;
+    };
+
+    vk::Device                      Device;
+    std::thread                     Thread;
+    bool                            StopRequested;
+    std::deque<PendingPresentData>  PendingPresents;
+    uint64_t                        SwapChainGeneration;
+    std::mutex                      SwapChainMutex;
+    std::condition_variable         PresentAdded;
+    std::vector<float>              Samples;
+    size_t                          NextSample;
+    mutable std::mutex              SamplesMutex;
+
+    void        WaitForPresents();
+  };
+
+} // namespace ApiWithoutSecrets
+
+#endif // LATENCY_MONITOR_HEADER
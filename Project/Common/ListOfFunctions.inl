@@ -366,6 +366,7 @@ VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkGetMemoryFdPropertiesKHR, VK_KHR_EXTE
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkGetMemoryHostPointerPropertiesEXT, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME )
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkGetPastPresentationTimingGOOGLE, VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME )
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkGetRefreshCycleDurationGOOGLE, VK_GOOGLE_DISPLAY_TIMING_EXTENSION_NAME )
+VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkWaitForPresentKHR, VK_KHR_PRESENT_WAIT_EXTENSION_NAME )
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkGetFenceFdKHR, VK_KHR_EXTERNAL_FENCE_FD_EXTENSION_NAME )
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkImportFenceFdKHR, VK_KHR_EXTERNAL_FENCE_FD_EXTENSION_NAME )
 VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( vkImportSemaphoreFdKHR, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME )
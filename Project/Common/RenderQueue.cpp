@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include "RenderQueue.h"
+#include "VulkanFunctions.h"
+
+namespace ApiWithoutSecrets {
+
+  RenderQueue::RenderQueue() :
+    Packets(),
+    Order(),
+    SortScratch(),
+    SortTime( 0.0f ) {
+  }
+
+  uint64_t RenderQueue::MakeSortKey( uint32_t pass, uint32_t pipeline, uint32_t descriptor_set, float depth ) {
+    // Bit pattern of a non-negative float grows together with its value
+    depth = std::min( std::max( depth, 0.0f ), 1.0f );
+    uint32_t depth_bits = 0;
+    std::memcpy( &depth_bits, &depth, sizeof( depth_bits ) );
+
+    return (static_cast<uint64_t>(std::min( pass, MaxPass )) << 56) |
+           (static_cast<uint64_t>(std::min( pipeline, MaxPipeline )) << 44) |
+           (static_cast<uint64_t>(std::min( descriptor_set, MaxDescriptorSet )) << 32) |
+           static_cast<uint64_t>(depth_bits);
+  }
+
+  uint32_t RenderQueue::GetPass( uint64_t sort_key ) {
+    return static_cast<uint32_t>(sort_key >> 56);
+  }
+
+  void RenderQueue::Clear() {
+    Packets.clear();
+    Order.clear();
+  }
+
+  void RenderQueue::Submit( DrawPacket const & packet ) {
+    Order.push_back( { packet.SortKey, static_cast<uint32_t>(Packets.size()) } );
+    Packets.push_back( packet );
+  }
+
+  void RenderQueue::Sort() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // LSD radix sort with 8-bit digits; it is stable so packets with equal keys keep the submission order
+    size_t count = Order.size();
+    SortScratch.resize( count );
+    for( uint32_t shift = 0; (shift < 64) && (count > 1); shift += 8 ) {
+      size_t offsets[256] = {};
+      for( auto const & entry : Order ) {
+        ++offsets[(entry.Key >> shift) & 0xFF];
+      }
+      // Pass is skipped when all keys have the same digit
+      if( offsets[(Order[0].Key >> shift) & 0xFF] == count ) {
+        continue;
+      }
+      size_t offset = 0;
+      for( size_t & digit_offset : offsets ) {
+        size_t digit_count = digit_offset;
+        digit_offset = offset;
+        offset += digit_count;
+      }
+      for( auto const & entry : Order ) {
+        SortScratch[offsets[(entry.Key >> shift) & 0xFF]++] = entry;
+      }
+      Order.swap( SortScratch );
+    }
+
+    auto sort_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time);
+    SortTime = SortTime * 0.99f + static_cast<float>(sort_time.count() * 0.001f) * 0.01f;
+  }
+
+  RenderQueueStatistics RenderQueue::Record( vk::CommandBuffer command_buffer, uint32_t pass ) const {
+    RenderQueueStatistics statistics;
+    vk::Pipeline current_pipeline;
+    vk::PipelineLayout current_pipeline_layout;
+    vk::DescriptorSet current_descriptor_set;
+    vk::DescriptorSet current_instance_descriptor_set;
+    vk::Buffer current_vertex_buffer;
+    vk::Buffer current_index_buffer;
+    vk::DeviceSize current_index_buffer_offset = 0;
+
+    for( auto const & entry : Order ) {
+      if( GetPass( entry.Key ) != pass ) {
+        continue;
+      }
+      DrawPacket const & packet = Packets[entry.Index];
+
+      if( packet.Pipeline != current_pipeline ) {
+        command_buffer.bindPipeline( vk::PipelineBindPoint::eGraphics, packet.Pipeline );
+        current_pipeline = packet.Pipeline;
+        ++statistics.PipelineBinds;
+      } else {
+        ++statistics.SkippedBinds;
+      }
+      // Sets bound with a different pipeline layout may be disturbed
+      bool layout_changed = packet.PipelineLayout != current_pipeline_layout;
+      current_pipeline_layout = packet.PipelineLayout;
+      if( layout_changed || (packet.DescriptorSet != current_descriptor_set) ) {
+        command_buffer.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, packet.PipelineLayout, 0, { packet.DescriptorSet }, {} );
+        current_descriptor_set = packet.DescriptorSet;
+        ++statistics.DescriptorSetBinds;
+      } else {
+        ++statistics.SkippedBinds;
+      }
+      if( layout_changed || (packet.InstanceDescriptorSet != current_instance_descriptor_set) ) {
+        command_buffer.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, packet.PipelineLayout, 1, { packet.InstanceDescriptorSet }, {} );
+        current_instance_descriptor_set = packet.InstanceDescriptorSet;
+        ++statistics.DescriptorSetBinds;
+      } else {
+        ++statistics.SkippedBinds;
+      }
+      // Packets without a vertex buffer generate vertices in a shader
+      if( packet.VertexBuffer ) {
+        if( packet.VertexBuffer != current_vertex_buffer ) {
+          command_buffer.bindVertexBuffers( 0, { packet.VertexBuffer }, { 0 } );
+          current_vertex_buffer = packet.VertexBuffer;
+          ++statistics.VertexBufferBinds;
+        } else {
+          ++statistics.SkippedBinds;
+        }
+      }
+      if( packet.IndexBuffer ) {
+        if( (packet.IndexBuffer != current_index_buffer) || (packet.IndexBufferOffset != current_index_buffer_offset) ) {
+          command_buffer.bindIndexBuffer( packet.IndexBuffer, packet.IndexBufferOffset, vk::IndexType::eUint32 );
+          current_index_buffer = packet.IndexBuffer;
+          current_index_buffer_offset = packet.IndexBufferOffset;
+          ++statistics.IndexBufferBinds;
+        } else {
+          ++statistics.SkippedBinds;
+        }
+      }
+
+      if( packet.IndirectBuffer ) {
+        if( packet.IndexBuffer ) {
+          command_buffer.drawIndexedIndirect( packet.IndirectBuffer, packet.IndirectOffset, 1, sizeof( vk::DrawIndexedIndirectCommand ) );
+        } else {
+          command_buffer.drawIndirect( packet.IndirectBuffer, packet.IndirectOffset, 1, sizeof( vk::DrawIndirectCommand ) );
+        }
+      } else if( packet.IndexBuffer ) {
+        command_buffer.drawIndexed( packet.IndexCount, packet.InstanceCount, packet.FirstIndex, packet.VertexOffset, packet.FirstInstance );
+      } else {
+        command_buffer.draw( packet.VertexCount, packet.InstanceCount, packet.FirstVertex, packet.FirstInstance );
+      }
+      ++statistics.DrawsCount;
+    }
+    return statistics;
+  }
+
+  size_t RenderQueue::GetSize() const {
+    return Packets.size();
+  }
+
+  float RenderQueue::GetSortTime() const {
+    return SortTime;
+  }
+
+  RenderQueue::~RenderQueue() {
+  }
+
+} // namespace ApiWithoutSecrets
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(RENDER_QUEUE_HEADER)
+#define RENDER_QUEUE_HEADER
+
+#include <cstdint>
+#include <vector>
+#include "vulkan.hpp"
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // DrawPacket                                                   //
+  //                                                              //
+  // State and parameters of a single draw call; push constants   //
+  // are not a part of a packet, they are set by the caller for a //
+  // pipeline layout shared by all packets                        //
+  // ************************************************************ //
+  struct DrawPacket {
+    uint64_t                SortKey;
+    vk::Pipeline            Pipeline;
+    vk::PipelineLayout      PipelineLayout;
+    vk::DescriptorSet       DescriptorSet;            // <- Set 0 - material data
+    vk::DescriptorSet       InstanceDescriptorSet;    // <- Set 1 - per-instance data
+    vk::Buffer              VertexBuffer;             // <- Not bound when empty, e.g. when vertices are generated in a shader
+    vk::Buffer              IndexBuffer;              // <- Indexed draw is recorded when it is provided
+    vk::DeviceSize          IndexBufferOffset;
+    vk::Buffer              IndirectBuffer;           // <- Draw parameters are read from this buffer when it is provided
+    vk::DeviceSize          IndirectOffset;
+    uint32_t                VertexCount;
+    uint32_t                IndexCount;
+    uint32_t                InstanceCount;
+    uint32_t                FirstVertex;
+    uint32_t                FirstIndex;
+    int32_t                 VertexOffset;
+    uint32_t                FirstInstance;
+
+    DrawPacket() :
+      SortKey( 0 ),
+      Pipeline(),
+      PipelineLayout(),
+      DescriptorSet(),
+      InstanceDescriptorSet(),
+      VertexBuffer(),
+      IndexBuffer(),
+      IndexBufferOffset( 0 ),
+      IndirectBuffer(),
+      IndirectOffset( 0 ),
+      VertexCount( 0 ),
+      IndexCount( 0 ),
+      InstanceCount( 0 ),
+      FirstVertex( 0 ),
+      FirstIndex( 0 ),
+      VertexOffset( 0 ),
+      FirstInstance( 0 ) {
+    }
+  };
+
+  // ************************************************************ //
+  // RenderQueueStatistics                                        //
+  //                                                              //
+  // Number of draws and state changes recorded from a queue      //
+  // ************************************************************ //
+  struct RenderQueueStatistics {
+    uint32_t    DrawsCount;
+    uint32_t    PipelineBinds;
+    uint32_t    DescriptorSetBinds;
+    uint32_t    VertexBufferBinds;
+    uint32_t    IndexBufferBinds;
+    uint32_t    SkippedBinds;         // <- Binds filtered out because the state was already set
+
+    RenderQueueStatistics() :
+      DrawsCount( 0 ),
+      PipelineBinds( 0 ),
+      DescriptorSetBinds( 0 ),
+      VertexBufferBinds( 0 ),
+      IndexBufferBinds( 0 ),
+      SkippedBinds( 0 ) {
+    }
+
+    uint32_t GetStateChangesCount() const {
+      return PipelineBinds + DescriptorSetBinds + VertexBufferBinds + IndexBufferBinds;
+    }
+  };
+
+  // ************************************************************ //
+  // RenderQueue                                                  //
+  //                                                              //
+  // Collects draw packets, orders them by their sort keys and    //
+  // records them into a command buffer binding only the state    //
+  // which differs from the previous draw; without sorting        //
+  // packets are recorded in the order of submission              //
+  // ************************************************************ //
+  class RenderQueue {
+  public:
+    static const uint32_t   MaxPass = 0xFF;
+    static const uint32_t   MaxPipeline = 0xFFF;
+    static const uint32_t   MaxDescriptorSet = 0xFFF;
+
+    // Pass occupies the most significant bits, then pipeline, descriptor set and depth
+    // Depth should be in the [0, 1] range, for back-to-front ordering pass 1 - depth
+    static uint64_t         MakeSortKey( uint32_t pass, uint32_t pipeline, uint32_t descriptor_set, float depth );
+    static uint32_t         GetPass( uint64_t sort_key );
+
+    void                    Clear();
+    void                    Submit( DrawPacket const & packet );
+    void                    Sort();
+    RenderQueueStatistics   Record( vk::CommandBuffer command_buffer, uint32_t pass ) const;
+
+    size_t                  GetSize() const;
+    float                   GetSortTime() const;
+
+    RenderQueue();
+    ~RenderQueue();
+
+  private:
+    struct SortEntry {
+      uint64_t    Key;
+      uint32_t    Index;
+    };
+
+    std::vector<DrawPacket> Packets;
+    std::vector<SortEntry>  Order;
+    std::vector<SortEntry>  SortScratch;
+    float                   SortTime;
+  };
+
+} // namespace ApiWithoutSecrets
+
+#endif // RENDER_QUEUE_HEADER
@@ -14,8 +14,10 @@
 // under the License.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include "SampleCommon.h"
 #include "VulkanFunctions.h"
+#include "VulkanCallCounters.h"
 
 namespace ApiWithoutSecrets {
 
@@ -23,7 +25,21 @@ namespace ApiWithoutSecrets {
     Title( title ),
     Gui( *this ),
     Timer(),
+    FrameNumber( 0 ),
+    CompletedFrameNumber( 0 ),
+    DeletionQueue(),
+    FrameLatency( 0.0f ),
+    FenceWaitTime( 0.0f ),
+    InputLatency(),
+    Jobs(),
+    WorkloadData(),
     FrameResources() {
+    // One core is left for the main thread, which also executes jobs while waiting for them;
+    // working sets are prepared up front but workers are started only when jobs are used
+    uint32_t thread_count = std::max( std::thread::hardware_concurrency(), 2u );
+    for( uint32_t i = 0; i < thread_count; ++i ) {
+      WorkloadData.emplace_back( new CpuWorkloadData() );
+    }
   }
 
   std::string const & SampleCommon::GetTitle() const {
@@ -34,12 +50,27 @@ namespace ApiWithoutSecrets {
     return Timer;
   }
 
+  float SampleCommon::GetFrameLatency() const {
+    return FrameLatency;
+  }
+
+  float SampleCommon::GetFenceWaitTime() const {
+    return FenceWaitTime;
+  }
+
+  LatencyMonitor const & SampleCommon::GetInputLatency() const {
+    return InputLatency;
+  }
+
   // Initialization
 
   void SampleCommon::Prepare( OS::WindowParameters window_parameters ) {
     FrameResources.resize( 3 );       // <- If necessary, this can be changed for each specific sample
 
     PrepareVulkan( window_parameters );
+    if( IsPresentWaitEnabled() ) {
+      InputLatency.Start( GetDevice() );
+    }
     PrepareSample();
     Gui.Prepare( FrameResources.size(), GetSwapChain().Extent.width, GetSwapChain().Extent.height );
   }
@@ -47,6 +78,12 @@ namespace ApiWithoutSecrets {
   // Drawing
 
   void SampleCommon::StartFrame( CurrentFrameData & current_frame ) {
+#if defined(VULKAN_CALL_COUNTERS)
+    CallCounters::FinishFrame();
+#endif
+    // Mouse state is sampled at the beginning of a frame - this is the starting point for latency measurements
+    auto frame_start_time = std::chrono::high_resolution_clock::now();
+
     Timer.Update();
     Gui.StartFrame( Timer, MouseState );
     PrepareGUIFrame();
@@ -54,26 +91,65 @@ namespace ApiWithoutSecrets {
     current_frame.ResourceIndex = (current_frame.ResourceIndex + 1) % current_frame.ResourceCount;
     current_frame.FrameResources = FrameResources[current_frame.ResourceIndex].get();
 
+    auto fence_wait_begin_time = std::chrono::high_resolution_clock::now();
     if( GetDevice().waitForFences( { *current_frame.FrameResources->Fence }, VK_FALSE, 1000000000 ) != vk::Result::eSuccess ) {
       throw std::exception( "Waiting for a fence takes too long!" );
     }
-    GetDevice().resetFences( { *current_frame.FrameResources->Fence } );
+    auto fence_wait_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - fence_wait_begin_time);
+    FenceWaitTime = static_cast<float>(fence_wait_time.count() * 0.001f);
+    UpdateFrameLatency();
+    current_frame.FrameResources->StartTime = frame_start_time;
+
+    // Queue executes submissions in order, so all frames up to the last one submitted with current resources are finished
+    CompletedFrameNumber = std::max( CompletedFrameNumber, current_frame.FrameResources->FrameNumber );
+    DeletionQueue.Release( CompletedFrameNumber );
+    ++FrameNumber;
   }
 
-  void SampleCommon::AcquireImage( CurrentFrameData & current_frame, vk::RenderPass & render_pass ) {
+  bool SampleCommon::AcquireImage( CurrentFrameData & current_frame, vk::RenderPass & render_pass ) {
     // Acquire swapchain image
-    switch (GetDevice().acquireNextImageKHR( *current_frame.Swapchain->Handle, 3000000000, *current_frame.FrameResources->ImageAvailableSemaphore, vk::Fence(), &current_frame.SwapchainImageIndex )) {
+    vk::Result result = vk::Result::eErrorOutOfDateKHR;
+    if( CanRender ) {
+      result = AcquireNextImage( current_frame );
+    }
+    if( result == vk::Result::eErrorOutOfDateKHR ) {
+      // Swapchain is recreated without waiting for the device so we can try again with the new one
+      OnWindowSizeChanged();
+      if( CanRender ) {
+        result = AcquireNextImage( current_frame );
+      }
+    }
+
+    switch( result ) {
     case vk::Result::eSuccess:
     case vk::Result::eSuboptimalKHR:
       break;
     case vk::Result::eErrorOutOfDateKHR:
-      OnWindowSizeChanged();
-      break;
+      // Nothing can be rendered in this frame
+      Gui.SkipFrame();
+      return false;
     default:
       throw std::exception( "Could not acquire swapchain image!" );
     }
-    // Create a framebuffer for current frame
+    // Create a framebuffer for current frame; the previous one is not destroyed in place but handed to the deletion queue
+    DeferDestruction( std::move( current_frame.FrameResources->Framebuffer ) );
     current_frame.FrameResources->Framebuffer = CreateFramebuffer( { *current_frame.Swapchain->ImageViews[current_frame.SwapchainImageIndex], *current_frame.FrameResources->DepthAttachment.View }, current_frame.Swapchain->Extent, render_pass );
+    return true;
+  }
+
+  vk::Result SampleCommon::AcquireNextImage( CurrentFrameData & current_frame ) {
+    if( !InputLatency.IsPresentWaitUsed() ) {
+      return GetDevice().acquireNextImageKHR( *current_frame.Swapchain->Handle, 3000000000, *current_frame.FrameResources->ImageAvailableSemaphore, vk::Fence(), &current_frame.SwapchainImageIndex );
+    }
+    // Swapchain is shared with the latency monitor thread so it is accessed in short slices (up to 3 seconds in total)
+    for( int i = 0; i < 3000; ++i ) {
+      std::lock_guard<std::mutex> lock( InputLatency.GetSwapChainMutex() );
+      vk::Result result = GetDevice().acquireNextImageKHR( *current_frame.Swapchain->Handle, 1000000, *current_frame.FrameResources->ImageAvailableSemaphore, vk::Fence(), &current_frame.SwapchainImageIndex );
+      if( result != vk::Result::eTimeout ) {
+        return result;
+      }
+    }
+    return vk::Result::eTimeout;
   }
 
   void SampleCommon::ClearFramebuffer( CurrentFrameData & current_frame, vk::CommandBuffer & command_buffer, vk::RenderPass & render_pass ) {
@@ -119,26 +195,36 @@ namespace ApiWithoutSecrets {
     }
   }
 
-  void SampleCommon::FinishFrame( CurrentFrameData & current_frame, vk::CommandBuffer & command_buffer, vk::RenderPass & render_pass ) {
+  void SampleCommon::FinishFrame( CurrentFrameData & current_frame, vk::CommandBuffer & command_buffer, vk::RenderPass & render_pass, vk::CommandBuffer const * final_command_buffer ) {
     // Draw GUI
     {
       Gui.Draw( current_frame.ResourceIndex, command_buffer, render_pass, *current_frame.FrameResources->Framebuffer );
 
+      // Optional command buffer is executed after the GUI, i.e. to write timestamps closing the whole frame
+      std::vector<vk::CommandBuffer> command_buffers = { command_buffer };
+      if( final_command_buffer != nullptr ) {
+        command_buffers.push_back( *final_command_buffer );
+      }
+
       vk::PipelineStageFlags wait_dst_stage_mask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
       vk::SubmitInfo submit_info(
         0,                                                            // uint32_t                     waitSemaphoreCount
         nullptr,                                                      // const VkSemaphore           *pWaitSemaphores
         &wait_dst_stage_mask,                                         // const VkPipelineStageFlags  *pWaitDstStageMask;
-        1,                                                            // uint32_t                     commandBufferCount
-        &command_buffer,                                              // const VkCommandBuffer       *pCommandBuffers
+        static_cast<uint32_t>(command_buffers.size()),                // uint32_t                     commandBufferCount
+        command_buffers.data(),                                       // const VkCommandBuffer       *pCommandBuffers
         1,                                                            // uint32_t                     signalSemaphoreCount
         &(*current_frame.FrameResources->FinishedRenderingSemaphore)  // const VkSemaphore           *pSignalSemaphores
       );
+      // Fence is reset only right before the submission so it stays signaled when a frame gets skipped
+      GetDevice().resetFences( { *current_frame.FrameResources->Fence } );
       GetGraphicsQueue().Handle.submit( { submit_info }, *current_frame.FrameResources->Fence );
+      // Frame number is stored only for submitted frames - skipped frames don't signal the fence
+      current_frame.FrameResources->FrameNumber = FrameNumber;
+      current_frame.FrameResources->LatencyPending = true;
     }
     // Present frame
     {
-      vk::Result result = vk::Result::eSuccess;
       vk::PresentInfoKHR present_info(
         1,                                                            // uint32_t                     waitSemaphoreCount
         &(*current_frame.FrameResources->FinishedRenderingSemaphore), // const VkSemaphore           *pWaitSemaphores
@@ -147,8 +233,33 @@ namespace ApiWithoutSecrets {
         &current_frame.SwapchainImageIndex                            // const uint32_t              *pImageIndices
       );
 
-      switch (GetPresentQueue().Handle.presentKHR( &present_info )) {
+      // Present is tagged with the frame number so the monitor thread can wait for it
+      uint64_t present_id_value = current_frame.FrameResources->FrameNumber;
+      VkPresentIdKHR present_id = {
+        VK_STRUCTURE_TYPE_PRESENT_ID_KHR,                             // VkStructureType              sType
+        nullptr,                                                      // const void                  *pNext
+        1,                                                            // uint32_t                     swapchainCount
+        &present_id_value                                             // const uint64_t              *pPresentIds
+      };
+      bool present_wait_used = InputLatency.IsPresentWaitUsed();
+      if( present_wait_used ) {
+        present_info.pNext = &present_id;
+      }
+
+      vk::Result result = vk::Result::eSuccess;
+      {
+        std::unique_lock<std::mutex> lock( InputLatency.GetSwapChainMutex(), std::defer_lock );
+        if( present_wait_used ) {
+          lock.lock();
+        }
+        result = GetPresentQueue().Handle.presentKHR( &present_info );
+      }
+
+      switch( result ) {
       case vk::Result::eSuccess:
+        if( present_wait_used ) {
+          InputLatency.AddPresent( *current_frame.Swapchain->Handle, present_id_value, current_frame.FrameResources->StartTime );
+        }
         break;
       case vk::Result::eSuboptimalKHR:
       case vk::Result::eErrorOutOfDateKHR:
@@ -160,7 +271,42 @@ namespace ApiWithoutSecrets {
     }
   }
 
+  void SampleCommon::UpdateFrameLatency() {
+    // Frame is finished when its fence gets signaled; fences are checked once per frame (and right after waiting
+    // for one of them) so the measured time is an upper bound of a time from the frame start to its completion
+    auto current_time = std::chrono::high_resolution_clock::now();
+    for( auto & frame_resources : FrameResources ) {
+      if( !frame_resources ||
+          !frame_resources->LatencyPending ||
+          (GetDevice().getFenceStatus( *frame_resources->Fence ) != vk::Result::eSuccess) ) {
+        continue;
+      }
+      frame_resources->LatencyPending = false;
+      if( !InputLatency.IsPresentWaitUsed() ) {
+        // Without present wait fence completion is the closest approximation of a presentation time
+        InputLatency.AddCompletion( frame_resources->StartTime, current_time );
+      }
+
+      auto latency = std::chrono::duration_cast<std::chrono::microseconds>(current_time - frame_resources->StartTime);
+      float float_latency = static_cast<float>(latency.count() * 0.001f);
+      FrameLatency = (FrameLatency > 0.0f) ? (FrameLatency * 0.99f + float_latency * 0.01f) : float_latency;
+    }
+  }
+
   void SampleCommon::OnWindowSizeChanged_Pre() {
+    // Current swapchain can't be accessed by the latency monitor thread when it is used to create a new one
+    if( GetSwapChain().Handle ) {
+      InputLatency.DiscardSwapChain( *GetSwapChain().Handle );
+    }
+
+    // Latency is measured separately for each swapchain configuration
+    FrameLatency = 0.0f;
+    for( auto & frame_resources : FrameResources ) {
+      if( frame_resources ) {
+        frame_resources->LatencyPending = false;
+      }
+    }
+
     OnSampleWindowSizeChanged_Pre();
   }
 
@@ -170,6 +316,17 @@ namespace ApiWithoutSecrets {
     OnSampleWindowSizeChanged_Post();
   }
 
+  void SampleCommon::RetireSwapChain( vk::UniqueSwapchainKHR & swap_chain, std::vector<vk::UniqueImageView> & image_views ) {
+    if( !swap_chain && image_views.empty() ) {
+      return;
+    }
+    // Old swapchain and its image views are released when all frames which could use them are finished
+    // Views are pushed first so they are destroyed before the swapchain which owns their images
+    DeferDestruction( std::move( image_views ) );
+    DeferDestruction( std::move( swap_chain ) );
+    image_views.clear();
+  }
+
   // Resource creation
 
   vk::UniqueShaderModule SampleCommon::CreateShaderModule( char const * filename ) const {
@@ -184,9 +341,9 @@ namespace ApiWithoutSecrets {
     return GetDevice().createShaderModuleUnique( shader_module_create_info );
   }
 
-  ImageParameters SampleCommon::CreateImage( uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::MemoryPropertyFlagBits property, vk::ImageAspectFlags aspect ) const {
+  ImageParameters SampleCommon::CreateImage( uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::MemoryPropertyFlagBits property, vk::ImageAspectFlags aspect, uint32_t mip_levels ) const {
     vk::UniqueImage tmp_image;
-    CreateImage( width, height, format, usage, tmp_image );
+    CreateImage( width, height, mip_levels, format, usage, tmp_image );
 
     vk::UniqueDeviceMemory tmp_memory;
     AllocateImageMemory( *tmp_image, property, tmp_memory );
@@ -194,7 +351,7 @@ namespace ApiWithoutSecrets {
     GetDevice().bindImageMemory( *tmp_image, *tmp_memory, vk::DeviceSize( 0 ) );
 
     vk::UniqueImageView tmp_view;
-    CreateImageView( *tmp_image, format, aspect, tmp_view );
+    CreateImageView( *tmp_image, format, aspect, mip_levels, tmp_view );
 
     ImageParameters image;
     image.Handle = std::move( tmp_image );
@@ -204,7 +361,7 @@ namespace ApiWithoutSecrets {
     return std::move( image );
   }
 
-  BufferParameters SampleCommon::CreateBuffer( uint32_t size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlagBits memoryProperty ) const {
+  BufferParameters SampleCommon::CreateBuffer( uint32_t size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags memoryProperty ) const {
     vk::UniqueBuffer tmp_buffer;
     CreateBuffer( size, usage, tmp_buffer );
 
@@ -221,12 +378,12 @@ namespace ApiWithoutSecrets {
     return std::move( buffer );
   }
 
-  DescriptorSetParameters SampleCommon::CreateDescriptorResources( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, std::vector<vk::DescriptorPoolSize> const & pool_sizes ) const {
+  DescriptorSetParameters SampleCommon::CreateDescriptorResources( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, std::vector<vk::DescriptorPoolSize> const & pool_sizes, bool update_after_bind ) const {
     vk::UniqueDescriptorSetLayout tmp_layout;
-    CreateDescriptorSetLayout( layout_bindings, tmp_layout );
+    CreateDescriptorSetLayout( layout_bindings, update_after_bind, tmp_layout );
 
     vk::UniqueDescriptorPool tmp_pool;
-    CreateDescriptorPool( pool_sizes, 1, tmp_pool );
+    CreateDescriptorPool( pool_sizes, 1, update_after_bind, tmp_pool );
 
     std::vector<vk::UniqueDescriptorSet> tmp_sets;
     AllocateDescriptorSets( { *tmp_layout }, *tmp_pool, tmp_sets );
@@ -239,6 +396,24 @@ namespace ApiWithoutSecrets {
     return std::move( descriptor_set );
   }
 
+  GeometryArenaParameters SampleCommon::CreateGeometryArena( GeometryArena const & arena ) const {
+    GeometryArenaParameters geometry;
+    geometry.Buffer = CreateBuffer( static_cast<uint32_t>(arena.GetSize()), vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal );
+    geometry.IndexOffset = arena.GetIndexOffset();
+    geometry.Meshes = arena.GetMeshes();
+
+    // Both regions live in the same buffer, so they are bound with different offsets
+    auto const & vertex_data = arena.GetVertexData();
+    auto const & index_data = arena.GetIndexData();
+    if( !vertex_data.empty() ) {
+      CopyDataToBuffer( static_cast<uint32_t>(vertex_data.size()), vertex_data.data(), *geometry.Buffer.Handle, 0, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::AccessFlagBits::eVertexAttributeRead, vk::PipelineStageFlagBits::eVertexInput );
+    }
+    if( !index_data.empty() ) {
+      CopyDataToBuffer( static_cast<uint32_t>(index_data.size() * sizeof( uint32_t )), index_data.data(), *geometry.Buffer.Handle, geometry.IndexOffset, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::AccessFlagBits::eIndexRead, vk::PipelineStageFlagBits::eVertexInput );
+    }
+    return std::move( geometry );
+  }
+
   vk::UniqueFramebuffer SampleCommon::CreateFramebuffer( std::vector<vk::ImageView> const & image_views, vk::Extent2D const & extent, vk::RenderPass const & render_pass ) const {
     vk::FramebufferCreateInfo framebuffer_create_info(
       vk::FramebufferCreateFlags( 0 ),                  // VkFramebufferCreateFlags       flags
@@ -253,7 +428,7 @@ namespace ApiWithoutSecrets {
     return GetDevice().createFramebufferUnique( framebuffer_create_info );
   }
 
-  vk::UniqueSampler SampleCommon::CreateSampler( vk::SamplerMipmapMode mipmap_mode, vk::SamplerAddressMode address_mode, vk::Bool32 unnormalized_coords ) const {
+  vk::UniqueSampler SampleCommon::CreateSampler( vk::SamplerMipmapMode mipmap_mode, vk::SamplerAddressMode address_mode, vk::Bool32 unnormalized_coords, float max_lod ) const {
     vk::SamplerCreateInfo sampler_create_info(
       vk::SamplerCreateFlags( 0 ),                  // VkSamplerCreateFlags       flags
       vk::Filter::eLinear,                          // VkFilter                   magFilter
@@ -268,7 +443,7 @@ namespace ApiWithoutSecrets {
       VK_FALSE,                                     // VkBool32                   compareEnable
       vk::CompareOp::eAlways,                       // VkCompareOp                compareOp
       0.0f,                                         // float                      minLod
-      0.0f,                                         // float                      maxLod
+      max_lod,                                      // float                      maxLod
       vk::BorderColor::eFloatOpaqueBlack,           // VkBorderColor              borderColor
       unnormalized_coords                           // VkBool32                   unnormalizedCoordinates
     );
@@ -330,6 +505,25 @@ namespace ApiWithoutSecrets {
     return GetDevice().createPipelineLayoutUnique( layout_create_info );
   }
 
+  vk::UniqueDescriptorUpdateTemplate SampleCommon::CreateDescriptorUpdateTemplate( vk::DescriptorSetLayout const & descriptor_set_layout, std::vector<vk::DescriptorUpdateTemplateEntry> const & entries ) const {
+    if( !IsDescriptorUpdateTemplateEnabled() ) {
+      throw std::exception( "Could not create descriptor update template - extension is not enabled!" );
+    }
+
+    vk::DescriptorUpdateTemplateCreateInfo template_create_info(
+      vk::DescriptorUpdateTemplateCreateFlags( 0 ),         // VkDescriptorUpdateTemplateCreateFlags  flags
+      static_cast<uint32_t>(entries.size()),                // uint32_t                               descriptorUpdateEntryCount
+      entries.data(),                                       // const VkDescriptorUpdateTemplateEntry *pDescriptorUpdateEntries
+      vk::DescriptorUpdateTemplateType::eDescriptorSet,     // VkDescriptorUpdateTemplateType         templateType
+      descriptor_set_layout,                                // VkDescriptorSetLayout                  descriptorSetLayout
+      vk::PipelineBindPoint::eGraphics,                     // VkPipelineBindPoint                    pipelineBindPoint
+      vk::PipelineLayout(),                                 // VkPipelineLayout                       pipelineLayout
+      0                                                     // uint32_t                               set
+    );
+
+    return GetDevice().createDescriptorUpdateTemplateUnique( template_create_info );
+  }
+
   vk::UniqueSemaphore SampleCommon::CreateSemaphore() const {
     return GetDevice().createSemaphoreUnique( {} );
   }
@@ -338,6 +532,17 @@ namespace ApiWithoutSecrets {
     return GetDevice().createFenceUnique( { signaled ? vk::FenceCreateFlagBits::eSignaled : vk::FenceCreateFlags( 0u ) } );
   }
 
+  vk::UniqueQueryPool SampleCommon::CreateQueryPool( vk::QueryType query_type, uint32_t query_count ) const {
+    vk::QueryPoolCreateInfo query_pool_create_info(
+      vk::QueryPoolCreateFlags( 0 ),                    // VkQueryPoolCreateFlags         flags
+      query_type,                                       // VkQueryType                    queryType
+      query_count,                                      // uint32_t                       queryCount
+      vk::QueryPipelineStatisticFlags( 0 )              // VkQueryPipelineStatisticFlags  pipelineStatistics
+    );
+
+    return GetDevice().createQueryPoolUnique( query_pool_create_info );
+  }
+
   vk::UniqueCommandPool SampleCommon::CreateCommandPool( uint32_t queue_family_index, vk::CommandPoolCreateFlags flags )  const {
     return GetDevice().createCommandPoolUnique( { flags, queue_family_index } );
   }
@@ -410,7 +615,7 @@ namespace ApiWithoutSecrets {
     }
   }
 
-  void SampleCommon::CopyDataToImage( uint32_t data_size, void const * data, vk::Image & target_image, uint32_t width, uint32_t height, vk::ImageSubresourceRange const & image_subresource_range, vk::ImageLayout current_image_layout, vk::AccessFlags current_image_access, vk::PipelineStageFlags generating_stages, vk::ImageLayout new_image_layout, vk::AccessFlags new_image_access, vk::PipelineStageFlags consuming_stages ) const {
+  void SampleCommon::CopyDataToImage( uint32_t data_size, void const * data, vk::Image & target_image, uint32_t width, uint32_t height, vk::ImageSubresourceRange const & image_subresource_range, vk::ImageLayout current_image_layout, vk::AccessFlags current_image_access, vk::PipelineStageFlags generating_stages, vk::ImageLayout new_image_layout, vk::AccessFlags new_image_access, vk::PipelineStageFlags consuming_stages, std::vector<uint32_t> const & level_offsets ) const {
     // Create staging buffer and map it's memory to copy data from the CPU
     StagingBufferParameters staging_buffer;
     {
@@ -451,8 +656,11 @@ namespace ApiWithoutSecrets {
       std::vector<vk::BufferImageCopy> buffer_image_copy;
       buffer_image_copy.reserve( image_subresource_range.levelCount );
       for( uint32_t i = image_subresource_range.baseMipLevel; i < image_subresource_range.baseMipLevel + image_subresource_range.levelCount; ++i ) {
+        // Each level is read from its own offset (if provided) and has its own, reduced size
+        uint32_t level = i - image_subresource_range.baseMipLevel;
+        vk::DeviceSize buffer_offset = level < level_offsets.size() ? level_offsets[level] : 0;
         buffer_image_copy.emplace_back(
-          0,                                          // VkDeviceSize                           bufferOffset
+          buffer_offset,                              // VkDeviceSize                           bufferOffset
           0,                                          // uint32_t                               bufferRowLength
           0,                                          // uint32_t                               bufferImageHeight
           vk::ImageSubresourceLayers(                 // VkImageSubresourceLayers               imageSubresource
@@ -463,8 +671,8 @@ namespace ApiWithoutSecrets {
           ),
           vk::Offset3D(),                             // VkOffset3D                             imageOffset
           vk::Extent3D(                               // VkExtent3D                             imageExtent
-            width,                                      // uint32_t                               width
-            height,                                     // uint32_t                               height
+            std::max( width >> i, 1u ),                 // uint32_t                               width
+            std::max( height >> i, 1u ),                // uint32_t                               height
             1                                           // uint32_t                               depth
           )
         );
@@ -501,6 +709,122 @@ namespace ApiWithoutSecrets {
     }
   }
 
+  void SampleCommon::GenerateMipmaps( vk::Image & target_image, vk::Format format, uint32_t width, uint32_t height, uint32_t mip_levels, vk::ImageLayout new_image_layout, vk::AccessFlags new_image_access, vk::PipelineStageFlags consuming_stages ) const {
+    // Base level must already contain image data and be in a TRANSFER_SRC_OPTIMAL layout
+    // Allocate temporary command buffer from a temporary command pool
+    vk::UniqueCommandPool command_pool = CreateCommandPool( GetGraphicsQueue().FamilyIndex, vk::CommandPoolCreateFlagBits::eTransient );
+    vk::UniqueCommandBuffer command_buffer = std::move( AllocateCommandBuffers( *command_pool, vk::CommandBufferLevel::ePrimary, 1 )[0] );
+
+    // Linear filtering during blits is allowed only for formats which support it, other formats are downsampled with a nearest filter
+    vk::Filter filter = IsFormatFeatureSupported( format, vk::FormatFeatureFlagBits::eSampledImageFilterLinear ) ? vk::Filter::eLinear : vk::Filter::eNearest;
+
+    // Record command buffer which downsamples each level into the next one
+    {
+      command_buffer->begin( { vk::CommandBufferUsageFlagBits::eOneTimeSubmit } );
+
+      for( uint32_t i = 1; i < mip_levels; ++i ) {
+        vk::ImageSubresourceRange level_subresource_range(
+          vk::ImageAspectFlagBits::eColor,            // VkImageAspectFlags                     aspectMask
+          i,                                          // uint32_t                               baseMipLevel
+          1,                                          // uint32_t                               levelCount
+          0,                                          // uint32_t                               baseArrayLayer
+          1                                           // uint32_t                               layerCount
+        );
+
+        vk::ImageMemoryBarrier pre_blit_image_memory_barrier(
+          vk::AccessFlags( 0 ),                       // VkAccessFlags                          srcAccessMask
+          vk::AccessFlagBits::eTransferWrite,         // VkAccessFlags                          dstAccessMask
+          vk::ImageLayout::eUndefined,                // VkImageLayout                          oldLayout
+          vk::ImageLayout::eTransferDstOptimal,       // VkImageLayout                          newLayout
+          VK_QUEUE_FAMILY_IGNORED,                    // uint32_t                               srcQueueFamilyIndex
+          VK_QUEUE_FAMILY_IGNORED,                    // uint32_t                               dstQueueFamilyIndex
+          target_image,                               // VkImage                                image
+          level_subresource_range                     // VkImageSubresourceRange                subresourceRange
+        );
+        command_buffer->pipelineBarrier( vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags( 0 ), {}, {}, { pre_blit_image_memory_barrier } );
+
+        vk::ImageBlit image_blit(
+          vk::ImageSubresourceLayers(                 // VkImageSubresourceLayers               srcSubresource
+            vk::ImageAspectFlagBits::eColor,            // VkImageAspectFlags                     aspectMask
+            i - 1,                                      // uint32_t                               mipLevel
+            0,                                          // uint32_t                               baseArrayLayer
+            1                                           // uint32_t                               layerCount
+          ),
+          {{                                          // VkOffset3D                             srcOffsets[2]
+            vk::Offset3D(),
+            vk::Offset3D( std::max( width >> (i - 1), 1u ), std::max( height >> (i - 1), 1u ), 1 )
+          }},
+          vk::ImageSubresourceLayers(                 // VkImageSubresourceLayers               dstSubresource
+            vk::ImageAspectFlagBits::eColor,            // VkImageAspectFlags                     aspectMask
+            i,                                          // uint32_t                               mipLevel
+            0,                                          // uint32_t                               baseArrayLayer
+            1                                           // uint32_t                               layerCount
+          ),
+          {{                                          // VkOffset3D                             dstOffsets[2]
+            vk::Offset3D(),
+            vk::Offset3D( std::max( width >> i, 1u ), std::max( height >> i, 1u ), 1 )
+          }}
+        );
+        command_buffer->blitImage( target_image, vk::ImageLayout::eTransferSrcOptimal, target_image, vk::ImageLayout::eTransferDstOptimal, { image_blit }, filter );
+
+        vk::ImageMemoryBarrier post_blit_image_memory_barrier(
+          vk::AccessFlagBits::eTransferWrite,         // VkAccessFlags                          srcAccessMask
+          vk::AccessFlagBits::eTransferRead,          // VkAccessFlags                          dstAccessMask
+          vk::ImageLayout::eTransferDstOptimal,       // VkImageLayout                          oldLayout
+          vk::ImageLayout::eTransferSrcOptimal,       // VkImageLayout                          newLayout
+          VK_QUEUE_FAMILY_IGNORED,                    // uint32_t                               srcQueueFamilyIndex
+          VK_QUEUE_FAMILY_IGNORED,                    // uint32_t                               dstQueueFamilyIndex
+          target_image,                               // VkImage                                image
+          level_subresource_range                     // VkImageSubresourceRange                subresourceRange
+        );
+        command_buffer->pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags( 0 ), {}, {}, { post_blit_image_memory_barrier } );
+      }
+
+      vk::ImageMemoryBarrier final_image_memory_barrier(
+        vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite, // VkAccessFlags                srcAccessMask
+        new_image_access,                             // VkAccessFlags                          dstAccessMask
+        vk::ImageLayout::eTransferSrcOptimal,         // VkImageLayout                          oldLayout
+        new_image_layout,                             // VkImageLayout                          newLayout
+        VK_QUEUE_FAMILY_IGNORED,                      // uint32_t                               srcQueueFamilyIndex
+        VK_QUEUE_FAMILY_IGNORED,                      // uint32_t                               dstQueueFamilyIndex
+        target_image,                                 // VkImage                                image
+        {                                             // VkImageSubresourceRange                subresourceRange
+          vk::ImageAspectFlagBits::eColor,              // VkImageAspectFlags                     aspectMask
+          0,                                            // uint32_t                               baseMipLevel
+          mip_levels,                                   // uint32_t                               levelCount
+          0,                                            // uint32_t                               baseArrayLayer
+          1                                             // uint32_t                               layerCount
+        }
+      );
+      command_buffer->pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, consuming_stages, vk::DependencyFlags( 0 ), {}, {}, { final_image_memory_barrier } );
+
+      command_buffer->end();
+    }
+    // Submit
+    {
+      vk::UniqueFence fence = CreateFence( false );
+
+      vk::SubmitInfo submit_info(
+        0,                                            // uint32_t                               waitSemaphoreCount
+        nullptr,                                      // const VkSemaphore                     *pWaitSemaphores
+        nullptr,                                      // const VkPipelineStageFlags            *pWaitDstStageMask
+        1,                                            // uint32_t                               commandBufferCount
+        &(*command_buffer)                            // const VkCommandBuffer                 *pCommandBuffers
+      );
+      GetGraphicsQueue().Handle.submit( { submit_info }, *fence );
+      GetDevice().waitForFences( { *fence }, VK_FALSE, 3000000000 );
+    }
+  }
+
+  bool SampleCommon::IsLinearBlitSupported( vk::Format format ) const {
+    return IsFormatFeatureSupported( format, vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst | vk::FormatFeatureFlagBits::eSampledImageFilterLinear );
+  }
+
+  bool SampleCommon::IsFormatFeatureSupported( vk::Format format, vk::FormatFeatureFlags features ) const {
+    vk::FormatProperties format_properties = GetPhysicalDevice().getFormatProperties( format );
+    return (format_properties.optimalTilingFeatures & features) == features;
+  }
+
   void SampleCommon::CopyDataToBuffer( uint32_t data_size, void const * data, vk::Buffer target_buffer, vk::DeviceSize buffer_offset, vk::AccessFlags current_buffer_access, vk::PipelineStageFlags generating_stages, vk::AccessFlags new_buffer_access, vk::PipelineStageFlags consuming_stages ) const {
     // Create staging buffer and map it's memory to copy data from the CPU
     StagingBufferParameters staging_buffer;
@@ -574,19 +898,39 @@ namespace ApiWithoutSecrets {
   }
 
   void SampleCommon::PerformHardcoreCalculations( int duration ) const {
-    auto start_time = std::chrono::high_resolution_clock::now();
-    long long calculations_time = 0;
+    PerformCalculations( 1000 * duration, CpuWorkload::Trigonometry );
+  }
+
+  void SampleCommon::PerformHardcoreCalculations( float duration, uint32_t tasks_count, CpuWorkload workload ) const {
+    long long total_duration = static_cast<long long>(1000.0f * duration);
+    if( tasks_count <= 1 ) {
+      PerformCalculations( total_duration, workload );
+      return;
+    }
+    if( !Jobs.IsStarted() ) {
+      Jobs.Start( static_cast<uint32_t>(WorkloadData.size()) - 1 );
+    }
+    // Total amount of work stays the same, it is only split into independent parts
+    long long task_duration = total_duration / tasks_count;
+    JobCounter counter( 0 );
+    for( uint32_t i = 0; i < tasks_count; ++i ) {
+      Jobs.Submit( [this, task_duration, workload]() {
+        PerformCalculations( task_duration, workload );
+      }, counter );
+    }
+    Jobs.Wait( counter );
+  }
 
-    do {
-      float _sin = std::sin( std::cos( GetTimer().GetTime() ) );
-      float _pow = std::pow( GetTimer().GetTime(), _sin );
-      float _cos = std::cos( std::sin( _pow ) );
+  uint32_t SampleCommon::GetJobThreadCount() const {
+    return Jobs.GetThreadCount();
+  }
 
-      calculations_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
-    } while( calculations_time < 1000 * duration );
+  void SampleCommon::PerformCalculations( long long duration, CpuWorkload workload ) const {
+    // Each thread uses its own working set
+    WorkloadData[Jobs.GetCurrentThreadIndex()]->Perform( workload, duration, GetTimer().GetTime() );
   }
 
-  void SampleCommon::CreateImage( uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::UniqueImage & image ) const {
+  void SampleCommon::CreateImage( uint32_t width, uint32_t height, uint32_t mip_levels, vk::Format format, vk::ImageUsageFlags usage, vk::UniqueImage & image ) const {
     vk::ImageCreateInfo image_create_info(
       vk::ImageCreateFlags( 0 ),                        // VkImageCreateFlags             flags
       vk::ImageType::e2D,                               // VkImageType                    imageType
@@ -596,7 +940,7 @@ namespace ApiWithoutSecrets {
         height,                                           // uint32_t                       height
         1                                                 // uint32_t                       depth
       },
-      1,                                                // uint32_t                       mipLevels
+      mip_levels,                                       // uint32_t                       mipLevels
       1,                                                // uint32_t                       arrayLayers
       vk::SampleCountFlagBits::e1,                      // VkSampleCountFlagBits          samples
       vk::ImageTiling::eOptimal,                        // VkImageTiling                  tiling
@@ -624,7 +968,7 @@ namespace ApiWithoutSecrets {
     throw std::exception( "Could not allocate a memory for an image!" );
   }
 
-  void SampleCommon::CreateImageView( vk::Image & image, vk::Format format, vk::ImageAspectFlags aspect, vk::UniqueImageView & image_view ) const {
+  void SampleCommon::CreateImageView( vk::Image & image, vk::Format format, vk::ImageAspectFlags aspect, uint32_t mip_levels, vk::UniqueImageView & image_view ) const {
     vk::ImageViewCreateInfo image_view_create_info(
       vk::ImageViewCreateFlags( 0 ),                    // VkImageViewCreateFlags         flags
       image,                                            // VkImage                        image
@@ -634,7 +978,7 @@ namespace ApiWithoutSecrets {
       {                                                 // VkImageSubresourceRange        subresourceRange
         aspect,                                           // VkImageAspectFlags             aspectMask
         0,                                                // uint32_t                       baseMipLevel
-        1,                                                // uint32_t                       levelCount
+        mip_levels,                                       // uint32_t                       levelCount
         0,                                                // uint32_t                       baseArrayLayer
         1                                                 // uint32_t                       layerCount
       }
@@ -651,7 +995,7 @@ namespace ApiWithoutSecrets {
     buffer = GetDevice().createBufferUnique( buffer_create_info );
   }
 
-  void SampleCommon::AllocateBufferMemory( vk::Buffer & buffer, vk::MemoryPropertyFlagBits property, vk::UniqueDeviceMemory & memory ) const {
+  void SampleCommon::AllocateBufferMemory( vk::Buffer & buffer, vk::MemoryPropertyFlags property, vk::UniqueDeviceMemory & memory ) const {
     vk::MemoryRequirements buffer_memory_requirements = GetDevice().getBufferMemoryRequirements( buffer );
     vk::PhysicalDeviceMemoryProperties memory_properties = GetPhysicalDevice().getMemoryProperties();
 
@@ -670,22 +1014,38 @@ namespace ApiWithoutSecrets {
     throw std::exception( "Could not allocate a memory for a buffer!" );
   }
 
-  void SampleCommon::CreateDescriptorSetLayout( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, vk::UniqueDescriptorSetLayout & set_layout ) const {
+  void SampleCommon::CreateDescriptorSetLayout( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, bool update_after_bind, vk::UniqueDescriptorSetLayout & set_layout ) const {
     vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_create_info( 
       vk::DescriptorSetLayoutCreateFlags( 0 ),              // VkDescriptorSetLayoutCreateFlags     flags
       static_cast<uint32_t>(layout_bindings.size()),        // uint32_t                             bindingCount
       layout_bindings.data()                                // const VkDescriptorSetLayoutBinding  *pBindings
     );
+
+    // Descriptors may be written while a set is bound and not all of them have to be valid (requires descriptor indexing)
+    std::vector<VkDescriptorBindingFlagsEXT> binding_flags( layout_bindings.size(), VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT );
+    VkDescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_create_info = {
+      VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,  // VkStructureType                     sType
+      nullptr,                                                                // const void                         *pNext
+      static_cast<uint32_t>(binding_flags.size()),                            // uint32_t                            bindingCount
+      binding_flags.data()                                                    // const VkDescriptorBindingFlagsEXT  *pBindingFlags
+    };
+    if( update_after_bind ) {
+      descriptor_set_layout_create_info.flags = static_cast<vk::DescriptorSetLayoutCreateFlagBits>(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT);
+      descriptor_set_layout_create_info.pNext = &binding_flags_create_info;
+    }
     set_layout = GetDevice().createDescriptorSetLayoutUnique( descriptor_set_layout_create_info );
   }
 
-  void SampleCommon::CreateDescriptorPool( std::vector<vk::DescriptorPoolSize> const & pool_sizes, uint32_t max_sets, vk::UniqueDescriptorPool & descriptor_pool ) const {
+  void SampleCommon::CreateDescriptorPool( std::vector<vk::DescriptorPoolSize> const & pool_sizes, uint32_t max_sets, bool update_after_bind, vk::UniqueDescriptorPool & descriptor_pool ) const {
     vk::DescriptorPoolCreateInfo descriptor_pool_create_info(
       vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, // VkDescriptorPoolCreateFlags          flags
       max_sets,                                             // uint32_t                             maxSets
       static_cast<uint32_t>(pool_sizes.size()),             // uint32_t                             poolSizeCount
       pool_sizes.data()                                     // const VkDescriptorPoolSize          *pPoolSizes
     );
+    if( update_after_bind ) {
+      descriptor_pool_create_info.flags |= static_cast<vk::DescriptorPoolCreateFlagBits>(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT);
+    }
     descriptor_pool = GetDevice().createDescriptorPoolUnique( descriptor_pool_create_info );
   }
 
@@ -700,9 +1060,12 @@ namespace ApiWithoutSecrets {
   }
 
   SampleCommon::~SampleCommon() {
+    Jobs.Stop();
+    InputLatency.Stop();
     if( GetDevice() ) {
       GetDevice().waitIdle();
     }
+    DeletionQueue.ReleaseAll();
   }
 
 } // namespace ApiWithoutSecrets
@@ -18,7 +18,13 @@
 #define SAMPLE_COMMON_HEADER
 
 #include <memory>
+#include <chrono>
 #include "GUI.h"
+#include "DeferredDeletionQueue.h"
+#include "LatencyMonitor.h"
+#include "JobSystem.h"
+#include "CpuWorkloads.h"
+#include "GeometryArena.h"
 
 namespace ApiWithoutSecrets {
 
@@ -47,13 +53,19 @@ namespace ApiWithoutSecrets {
     vk::UniqueSemaphore                   ImageAvailableSemaphore;
     vk::UniqueSemaphore                   FinishedRenderingSemaphore;
     vk::UniqueFence                       Fence;
+    uint64_t                              FrameNumber;
+    std::chrono::high_resolution_clock::time_point  StartTime;
+    bool                                  LatencyPending;
 
     FrameResourcesData() :
       DepthAttachment(),
       Framebuffer(),
       ImageAvailableSemaphore(),
       FinishedRenderingSemaphore(),
-      Fence() {
+      Fence(),
+      FrameNumber( 0 ),
+      StartTime(),
+      LatencyPending( false ) {
     }
 
     virtual ~FrameResourcesData() {
@@ -114,6 +126,9 @@ namespace ApiWithoutSecrets {
 
     std::string const & GetTitle() const;
     TimerData const   & GetTimer() const;
+    float               GetFrameLatency() const;
+    float               GetFenceWaitTime() const;
+    LatencyMonitor const & GetInputLatency() const;
 
     void                Prepare( OS::WindowParameters window_parameters );
 
@@ -124,51 +139,80 @@ namespace ApiWithoutSecrets {
     virtual void        PrepareGUIFrame() = 0;                // <- Required to add sample-specific GUI
   
     void                StartFrame( CurrentFrameData & current_frame );
-    void                AcquireImage( CurrentFrameData & current_frame, vk::RenderPass & render_pass );
+    bool                AcquireImage( CurrentFrameData & current_frame, vk::RenderPass & render_pass );
     void                ClearFramebuffer( CurrentFrameData &current_frame, vk::CommandBuffer & command_buffer, vk::RenderPass & render_pass );
-    void                FinishFrame( CurrentFrameData & current_frame, vk::CommandBuffer & command_buffer, vk::RenderPass & render_pass );
+    void                FinishFrame( CurrentFrameData & current_frame, vk::CommandBuffer & command_buffer, vk::RenderPass & render_pass, vk::CommandBuffer const * final_command_buffer = nullptr );
 
     virtual void        OnWindowSizeChanged_Pre() override;
     virtual void        OnWindowSizeChanged_Post() override;
+    virtual void        RetireSwapChain( vk::UniqueSwapchainKHR & swap_chain, std::vector<vk::UniqueImageView> & image_views ) override;
 
     virtual void        OnSampleWindowSizeChanged_Pre() = 0;
     virtual void        OnSampleWindowSizeChanged_Post() = 0;
 
   public:
     vk::UniqueShaderModule                CreateShaderModule( char const * filename ) const;
-    ImageParameters                       CreateImage( uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::MemoryPropertyFlagBits property, vk::ImageAspectFlags aspect ) const;
-    BufferParameters                      CreateBuffer( uint32_t size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlagBits memoryProperty ) const;
-    DescriptorSetParameters               CreateDescriptorResources( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, std::vector<vk::DescriptorPoolSize> const & pool_sizes ) const;
+    ImageParameters                       CreateImage( uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::MemoryPropertyFlagBits property, vk::ImageAspectFlags aspect, uint32_t mip_levels = 1 ) const;
+    BufferParameters                      CreateBuffer( uint32_t size, vk::BufferUsageFlags usage, vk::MemoryPropertyFlags memoryProperty ) const;
+    DescriptorSetParameters               CreateDescriptorResources( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, std::vector<vk::DescriptorPoolSize> const & pool_sizes, bool update_after_bind = false ) const;
+    GeometryArenaParameters               CreateGeometryArena( GeometryArena const & arena ) const;
     vk::UniqueFramebuffer                 CreateFramebuffer( std::vector<vk::ImageView> const & image_views, vk::Extent2D const & extent, vk::RenderPass const & render_pass ) const;
-    vk::UniqueSampler                     CreateSampler( vk::SamplerMipmapMode mipmap_mode, vk::SamplerAddressMode address_mode, vk::Bool32 unnormalized_coords ) const;
+    vk::UniqueSampler                     CreateSampler( vk::SamplerMipmapMode mipmap_mode, vk::SamplerAddressMode address_mode, vk::Bool32 unnormalized_coords, float max_lod = 0.0f ) const;
     vk::UniqueRenderPass                  CreateRenderPass( std::vector<RenderPassAttachmentData> const & attachment_descriptions, std::vector<RenderPassSubpassData> const & subpass_descriptions, std::vector<vk::SubpassDependency> const & dependencies ) const;
     vk::UniquePipelineLayout              CreatePipelineLayout( std::vector<vk::DescriptorSetLayout> const & descriptor_set_layouts, std::vector<vk::PushConstantRange> const & push_constant_ranges ) const;
+    vk::UniqueDescriptorUpdateTemplate    CreateDescriptorUpdateTemplate( vk::DescriptorSetLayout const & descriptor_set_layout, std::vector<vk::DescriptorUpdateTemplateEntry> const & entries ) const;
     vk::UniqueSemaphore                   CreateSemaphore() const;
     vk::UniqueFence                       CreateFence( bool signaled ) const;
+    vk::UniqueQueryPool                   CreateQueryPool( vk::QueryType query_type, uint32_t query_count ) const;
     vk::UniqueCommandPool                 CreateCommandPool( uint32_t queue_family_index, vk::CommandPoolCreateFlags flags ) const;
     std::vector<vk::UniqueCommandBuffer>  AllocateCommandBuffers( vk::CommandPool const & pool, vk::CommandBufferLevel level, uint32_t count ) const;
   
     void                UpdateDescriptorSet( vk::DescriptorSet & descriptor_set, vk::DescriptorType descriptor_type, uint32_t binding, uint32_t array_element, std::vector<vk::DescriptorImageInfo> const & image_infos = {}, std::vector<vk::DescriptorBufferInfo> const & buffer_infos = {}, std::vector<vk::BufferView> const & buffer_views = {} ) const;
     void                SetImageMemoryBarrier( vk::Image const & image, vk::ImageSubresourceRange const & image_subresource_range, vk::ImageLayout current_image_layout, vk::AccessFlags current_image_access, vk::PipelineStageFlags generating_stages, vk::ImageLayout new_image_layout, vk::AccessFlags new_image_access, vk::PipelineStageFlags consuming_stages ) const;
-    void                CopyDataToImage( uint32_t data_size, void const * data, vk::Image & target_image, uint32_t width, uint32_t height, vk::ImageSubresourceRange const & image_subresource_range, vk::ImageLayout current_image_layout, vk::AccessFlags current_image_access, vk::PipelineStageFlags generating_stages, vk::ImageLayout new_image_layout, vk::AccessFlags new_image_access, vk::PipelineStageFlags consuming_stages ) const;
+    void                CopyDataToImage( uint32_t data_size, void const * data, vk::Image & target_image, uint32_t width, uint32_t height, vk::ImageSubresourceRange const & image_subresource_range, vk::ImageLayout current_image_layout, vk::AccessFlags current_image_access, vk::PipelineStageFlags generating_stages, vk::ImageLayout new_image_layout, vk::AccessFlags new_image_access, vk::PipelineStageFlags consuming_stages, std::vector<uint32_t> const & level_offsets = {} ) const;
+    void                GenerateMipmaps( vk::Image & target_image, vk::Format format, uint32_t width, uint32_t height, uint32_t mip_levels, vk::ImageLayout new_image_layout, vk::AccessFlags new_image_access, vk::PipelineStageFlags consuming_stages ) const;
+    bool                IsLinearBlitSupported( vk::Format format ) const;
+    bool                IsFormatFeatureSupported( vk::Format format, vk::FormatFeatureFlags features ) const;
     void                CopyDataToBuffer( uint32_t data_size, void const * data, vk::Buffer target_buffer, vk::DeviceSize buffer_offset, vk::AccessFlags current_buffer_access, vk::PipelineStageFlags generating_stages, vk::AccessFlags new_buffer_access, vk::PipelineStageFlags consuming_stages ) const;
     void                PerformHardcoreCalculations( int duration ) const;
+    void                PerformHardcoreCalculations( float duration, uint32_t tasks_count, CpuWorkload workload = CpuWorkload::Trigonometry ) const;
+    uint32_t            GetJobThreadCount() const;
+
+    template<class T>
+    void                DeferDestruction( T && object ) const;
   
   private:
     std::string                                         Title;
     GUI                                                 Gui;
     TimerData                                           Timer;
+    uint64_t                                            FrameNumber;
+    uint64_t                                            CompletedFrameNumber;
+    mutable DeferredDeletionQueue                       DeletionQueue;
+    float                                               FrameLatency;
+    float                                               FenceWaitTime;
+    LatencyMonitor                                      InputLatency;
+    mutable JobSystem                                   Jobs;
+    std::vector<std::unique_ptr<CpuWorkloadData>>       WorkloadData;           // <- Working set of each job system thread
   
-    void                CreateImage( uint32_t width, uint32_t height, vk::Format format, vk::ImageUsageFlags usage, vk::UniqueImage & image ) const;
+    void                UpdateFrameLatency();
+    void                PerformCalculations( long long duration, CpuWorkload workload ) const;
+    vk::Result          AcquireNextImage( CurrentFrameData & current_frame );
+    void                CreateImage( uint32_t width, uint32_t height, uint32_t mip_levels, vk::Format format, vk::ImageUsageFlags usage, vk::UniqueImage & image ) const;
     void                AllocateImageMemory( vk::Image & image, vk::MemoryPropertyFlagBits property, vk::UniqueDeviceMemory & memory ) const;
-    void                CreateImageView( vk::Image & image, vk::Format format, vk::ImageAspectFlags aspect, vk::UniqueImageView & image_view ) const;
+    void                CreateImageView( vk::Image & image, vk::Format format, vk::ImageAspectFlags aspect, uint32_t mip_levels, vk::UniqueImageView & image_view ) const;
     void                CreateBuffer( uint32_t size, vk::BufferUsageFlags usage, vk::UniqueBuffer & buffer ) const;
-    void                AllocateBufferMemory( vk::Buffer & buffer, vk::MemoryPropertyFlagBits property, vk::UniqueDeviceMemory & memory ) const;
-    void                CreateDescriptorSetLayout( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, vk::UniqueDescriptorSetLayout & set_layout ) const;
-    void                CreateDescriptorPool( std::vector<vk::DescriptorPoolSize> const & pool_sizes, uint32_t max_sets, vk::UniqueDescriptorPool & descriptor_pool ) const;
+    void                AllocateBufferMemory( vk::Buffer & buffer, vk::MemoryPropertyFlags property, vk::UniqueDeviceMemory & memory ) const;
+    void                CreateDescriptorSetLayout( std::vector<vk::DescriptorSetLayoutBinding> const & layout_bindings, bool update_after_bind, vk::UniqueDescriptorSetLayout & set_layout ) const;
+    void                CreateDescriptorPool( std::vector<vk::DescriptorPoolSize> const & pool_sizes, uint32_t max_sets, bool update_after_bind, vk::UniqueDescriptorPool & descriptor_pool ) const;
     void                AllocateDescriptorSets( std::vector<vk::DescriptorSetLayout> const & descriptor_set_layout, vk::DescriptorPool & descriptor_pool, std::vector<vk::UniqueDescriptorSet> & descriptor_sets ) const;
   };
 
+  template<class T>
+  void SampleCommon::DeferDestruction( T && object ) const {
+    // Object may still be used by any frame submitted up to this moment, including the current one
+    DeletionQueue.Push( FrameNumber, std::forward<T>( object ) );
+  }
+
 } // namespace ApiWithoutSecrets
 
 #endif // SAMPLE_COMMON_HEADER
\ No newline at end of file
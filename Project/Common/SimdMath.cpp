@@ -0,0 +1,505 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <vector>
+#include "SimdMath.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_MATH_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SIMD_MATH_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_MATH_NEON
+#endif
+
+namespace ApiWithoutSecrets {
+
+  namespace Math {
+
+    namespace {
+
+      // ************************************************************ //
+      // Four-wide operations used by matrix and vector functions     //
+      // ************************************************************ //
+#if defined(SIMD_MATH_AVX2) || defined(SIMD_MATH_SSE)
+      typedef __m128 Float4;
+
+      inline Float4 Load4( float const * data ) { return _mm_load_ps( data ); }
+      inline void   Store4( float * data, Float4 value ) { _mm_store_ps( data, value ); }
+      inline Float4 Splat4( float value ) { return _mm_set1_ps( value ); }
+      inline Float4 Mul4( Float4 a, Float4 b ) { return _mm_mul_ps( a, b ); }
+      inline Float4 MulAdd4( Float4 a, Float4 b, Float4 c ) { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+#elif defined(SIMD_MATH_NEON)
+      typedef float32x4_t Float4;
+
+      inline Float4 Load4( float const * data ) { return vld1q_f32( data ); }
+      inline void   Store4( float * data, Float4 value ) { vst1q_f32( data, value ); }
+      inline Float4 Splat4( float value ) { return vdupq_n_f32( value ); }
+      inline Float4 Mul4( Float4 a, Float4 b ) { return vmulq_f32( a, b ); }
+      inline Float4 MulAdd4( Float4 a, Float4 b, Float4 c ) { return vmlaq_f32( c, a, b ); }
+#else
+      struct Float4 {
+        float   Values[4];
+      };
+
+      inline Float4 Load4( float const * data ) { Float4 result = { { data[0], data[1], data[2], data[3] } }; return result; }
+      inline void   Store4( float * data, Float4 value ) { for( int i = 0; i < 4; ++i ) { data[i] = value.Values[i]; } }
+      inline Float4 Splat4( float value ) { Float4 result = { { value, value, value, value } }; return result; }
+      inline Float4 Mul4( Float4 a, Float4 b ) { for( int i = 0; i < 4; ++i ) { a.Values[i] *= b.Values[i]; } return a; }
+      inline Float4 MulAdd4( Float4 a, Float4 b, Float4 c ) { for( int i = 0; i < 4; ++i ) { c.Values[i] += a.Values[i] * b.Values[i]; } return c; }
+#endif
+
+      // ************************************************************ //
+      // Widest operations used by batched kernels                    //
+      // ************************************************************ //
+#if defined(SIMD_MATH_AVX2)
+      typedef __m256 FloatN;
+      typedef __m256 MaskN;
+      const size_t SimdWidth = 8;
+
+      inline FloatN   LoadN( float const * data ) { return _mm256_loadu_ps( data ); }
+      inline void     StoreN( float * data, FloatN value ) { _mm256_storeu_ps( data, value ); }
+      inline FloatN   SplatN( float value ) { return _mm256_set1_ps( value ); }
+      inline FloatN   AddN( FloatN a, FloatN b ) { return _mm256_add_ps( a, b ); }
+#if defined(__FMA__)
+      inline FloatN   MulAddN( FloatN a, FloatN b, FloatN c ) { return _mm256_fmadd_ps( a, b, c ); }
+#else
+      inline FloatN   MulAddN( FloatN a, FloatN b, FloatN c ) { return _mm256_add_ps( _mm256_mul_ps( a, b ), c ); }
+#endif
+      inline MaskN    GreaterEqualN( FloatN a, FloatN b ) { return _mm256_cmp_ps( a, b, _CMP_GE_OQ ); }
+      inline MaskN    AndN( MaskN a, MaskN b ) { return _mm256_and_ps( a, b ); }
+      inline uint32_t GetMaskBits( MaskN mask ) { return static_cast<uint32_t>(_mm256_movemask_ps( mask )); }
+#elif defined(SIMD_MATH_SSE)
+      typedef __m128 FloatN;
+      typedef __m128 MaskN;
+      const size_t SimdWidth = 4;
+
+      inline FloatN   LoadN( float const * data ) { return _mm_loadu_ps( data ); }
+      inline void     StoreN( float * data, FloatN value ) { _mm_storeu_ps( data, value ); }
+      inline FloatN   SplatN( float value ) { return _mm_set1_ps( value ); }
+      inline FloatN   AddN( FloatN a, FloatN b ) { return _mm_add_ps( a, b ); }
+      inline FloatN   MulAddN( FloatN a, FloatN b, FloatN c ) { return _mm_add_ps( _mm_mul_ps( a, b ), c ); }
+      inline MaskN    GreaterEqualN( FloatN a, FloatN b ) { return _mm_cmpge_ps( a, b ); }
+      inline MaskN    AndN( MaskN a, MaskN b ) { return _mm_and_ps( a, b ); }
+      inline uint32_t GetMaskBits( MaskN mask ) { return static_cast<uint32_t>(_mm_movemask_ps( mask )); }
+#elif defined(SIMD_MATH_NEON)
+      typedef float32x4_t FloatN;
+      typedef uint32x4_t  MaskN;
+      const size_t SimdWidth = 4;
+
+      inline FloatN   LoadN( float const * data ) { return vld1q_f32( data ); }
+      inline void     StoreN( float * data, FloatN value ) { vst1q_f32( data, value ); }
+      inline FloatN   SplatN( float value ) { return vdupq_n_f32( value ); }
+      inline FloatN   AddN( FloatN a, FloatN b ) { return vaddq_f32( a, b ); }
+      inline FloatN   MulAddN( FloatN a, FloatN b, FloatN c ) { return vmlaq_f32( c, a, b ); }
+      inline MaskN    GreaterEqualN( FloatN a, FloatN b ) { return vcgeq_f32( a, b ); }
+      inline MaskN    AndN( MaskN a, MaskN b ) { return vandq_u32( a, b ); }
+      inline uint32_t GetMaskBits( MaskN mask ) {
+        return (vgetq_lane_u32( mask, 0 ) & 1) | (vgetq_lane_u32( mask, 1 ) & 2) | (vgetq_lane_u32( mask, 2 ) & 4) | (vgetq_lane_u32( mask, 3 ) & 8);
+      }
+#else
+      typedef float FloatN;
+      typedef bool  MaskN;
+      const size_t SimdWidth = 1;
+
+      inline FloatN   LoadN( float const * data ) { return *data; }
+      inline void     StoreN( float * data, FloatN value ) { *data = value; }
+      inline FloatN   SplatN( float value ) { return value; }
+      inline FloatN   AddN( FloatN a, FloatN b ) { return a + b; }
+      inline FloatN   MulAddN( FloatN a, FloatN b, FloatN c ) { return a * b + c; }
+      inline MaskN    GreaterEqualN( FloatN a, FloatN b ) { return a >= b; }
+      inline MaskN    AndN( MaskN a, MaskN b ) { return a && b; }
+      inline uint32_t GetMaskBits( MaskN mask ) { return mask ? 1 : 0; }
+#endif
+
+      inline float Dot( Vec4 const & plane, float x, float y, float z ) {
+        return plane.X * x + plane.Y * y + plane.Z * z + plane.W;
+      }
+
+      // Sphere touches one of the planes so closely that rounding (i.e. fused multiply-add) may put it on either side
+      inline bool IsSphereOnFrustumBoundary( Frustum const & frustum, float x, float y, float z, float radius ) {
+        for( auto & plane : frustum.Planes ) {
+          float magnitude = std::abs( plane.X * x ) + std::abs( plane.Y * y ) + std::abs( plane.Z * z ) + std::abs( plane.W ) + radius;
+          if( std::abs( Dot( plane, x, y, z ) + radius ) <= 0.0001f * magnitude ) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+    } // namespace
+
+    char const * GetInstructionSet() {
+#if defined(SIMD_MATH_AVX2)
+      return "AVX2";
+#elif defined(SIMD_MATH_SSE)
+      return "SSE";
+#elif defined(SIMD_MATH_NEON)
+      return "NEON";
+#else
+      return "Scalar";
+#endif
+    }
+
+    Mat4 Mat4::Identity() {
+      return Mat4( { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } );
+    }
+
+    Mat4 Multiply( Mat4 const & left, Mat4 const & right ) {
+      // Each column of a result is a combination of left matrix's columns
+      Float4 column_0 = Load4( &left.Data[0] );
+      Float4 column_1 = Load4( &left.Data[4] );
+      Float4 column_2 = Load4( &left.Data[8] );
+      Float4 column_3 = Load4( &left.Data[12] );
+
+      Mat4 result;
+      for( int i = 0; i < 4; ++i ) {
+        Float4 column = Mul4( column_0, Splat4( right.Data[4 * i + 0] ) );
+        column = MulAdd4( column_1, Splat4( right.Data[4 * i + 1] ), column );
+        column = MulAdd4( column_2, Splat4( right.Data[4 * i + 2] ), column );
+        column = MulAdd4( column_3, Splat4( right.Data[4 * i + 3] ), column );
+        Store4( &result.Data[4 * i], column );
+      }
+      return result;
+    }
+
+    Vec4 Transform( Mat4 const & matrix, Vec4 const & vector ) {
+      Float4 result = Mul4( Load4( &matrix.Data[0] ), Splat4( vector.X ) );
+      result = MulAdd4( Load4( &matrix.Data[4] ), Splat4( vector.Y ), result );
+      result = MulAdd4( Load4( &matrix.Data[8] ), Splat4( vector.Z ), result );
+      result = MulAdd4( Load4( &matrix.Data[12] ), Splat4( vector.W ), result );
+
+      Vec4 transformed;
+      Store4( &transformed.X, result );
+      return transformed;
+    }
+
+    Mat4 Transpose( Mat4 const & matrix ) {
+      Mat4 result;
+      for( int column = 0; column < 4; ++column ) {
+        for( int row = 0; row < 4; ++row ) {
+          result.Data[4 * row + column] = matrix.Data[4 * column + row];
+        }
+      }
+      return result;
+    }
+
+    Mat4 Inverse( Mat4 const & matrix ) {
+      // Inverse calculated from cofactors; singular matrices give an identity
+      auto const & m = matrix.Data;
+      std::array<float, 16> inv;
+
+      inv[0]  =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+      inv[4]  = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+      inv[8]  =  m[4] * m[9]  * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+      inv[12] = -m[4] * m[9]  * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+      inv[1]  = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+      inv[5]  =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+      inv[9]  = -m[0] * m[9]  * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+      inv[13] =  m[0] * m[9]  * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+      inv[2]  =  m[1] * m[6]  * m[15] - m[1] * m[7]  * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7]  - m[13] * m[3] * m[6];
+      inv[6]  = -m[0] * m[6]  * m[15] + m[0] * m[7]  * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7]  + m[12] * m[3] * m[6];
+      inv[10] =  m[0] * m[5]  * m[15] - m[0] * m[7]  * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7]  - m[12] * m[3] * m[5];
+      inv[14] = -m[0] * m[5]  * m[14] + m[0] * m[6]  * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6]  + m[12] * m[2] * m[5];
+      inv[3]  = -m[1] * m[6]  * m[11] + m[1] * m[7]  * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9]  * m[2] * m[7]  + m[9]  * m[3] * m[6];
+      inv[7]  =  m[0] * m[6]  * m[11] - m[0] * m[7]  * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8]  * m[2] * m[7]  - m[8]  * m[3] * m[6];
+      inv[11] = -m[0] * m[5]  * m[11] + m[0] * m[7]  * m[9]  + m[4] * m[1] * m[11] - m[4] * m[3] * m[9]  - m[8]  * m[1] * m[7]  + m[8]  * m[3] * m[5];
+      inv[15] =  m[0] * m[5]  * m[10] - m[0] * m[6]  * m[9]  - m[4] * m[1] * m[10] + m[4] * m[2] * m[9]  + m[8]  * m[1] * m[6]  - m[8]  * m[2] * m[5];
+
+      float determinant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+      if( determinant == 0.0f ) {
+        return Mat4::Identity();
+      }
+
+      Mat4 result( inv );
+      Float4 inverse_determinant = Splat4( 1.0f / determinant );
+      for( int i = 0; i < 4; ++i ) {
+        Store4( &result.Data[4 * i], Mul4( Load4( &result.Data[4 * i] ), inverse_determinant ) );
+      }
+      return result;
+    }
+
+    Frustum GetFrustum( Mat4 const & view_projection ) {
+      // Planes are combinations of matrix rows (Gribb-Hartmann); clip space depth is in [0, w]
+      auto const & m = view_projection.Data;
+      Vec4 row_0( m[0], m[4], m[8], m[12] );
+      Vec4 row_1( m[1], m[5], m[9], m[13] );
+      Vec4 row_2( m[2], m[6], m[10], m[14] );
+      Vec4 row_3( m[3], m[7], m[11], m[15] );
+
+      Frustum frustum;
+      frustum.Planes[0] = Vec4( row_3.X + row_0.X, row_3.Y + row_0.Y, row_3.Z + row_0.Z, row_3.W + row_0.W );
+      frustum.Planes[1] = Vec4( row_3.X - row_0.X, row_3.Y - row_0.Y, row_3.Z - row_0.Z, row_3.W - row_0.W );
+      frustum.Planes[2] = Vec4( row_3.X + row_1.X, row_3.Y + row_1.Y, row_3.Z + row_1.Z, row_3.W + row_1.W );
+      frustum.Planes[3] = Vec4( row_3.X - row_1.X, row_3.Y - row_1.Y, row_3.Z - row_1.Z, row_3.W - row_1.W );
+      frustum.Planes[4] = row_2;
+      frustum.Planes[5] = Vec4( row_3.X - row_2.X, row_3.Y - row_2.Y, row_3.Z - row_2.Z, row_3.W - row_2.W );
+
+      for( auto & plane : frustum.Planes ) {
+        float length = std::sqrt( plane.X * plane.X + plane.Y * plane.Y + plane.Z * plane.Z );
+        if( length > 0.0f ) {
+          plane = Vec4( plane.X / length, plane.Y / length, plane.Z / length, plane.W / length );
+        }
+      }
+      return frustum;
+    }
+
+    bool IsSphereInFrustum( Frustum const & frustum, Vec4 const & center, float radius ) {
+      for( auto & plane : frustum.Planes ) {
+        if( Dot( plane, center.X, center.Y, center.Z ) + radius < 0.0f ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    bool IsAabbInFrustum( Frustum const & frustum, Vec4 const & min, Vec4 const & max ) {
+      // Box is outside when its corner furthest along a plane's normal is behind the plane
+      for( auto & plane : frustum.Planes ) {
+        float x = (plane.X >= 0.0f) ? max.X : min.X;
+        float y = (plane.Y >= 0.0f) ? max.Y : min.Y;
+        float z = (plane.Z >= 0.0f) ? max.Z : min.Z;
+        if( Dot( plane, x, y, z ) < 0.0f ) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void TransformPoints( Mat4 const & matrix, float const * x, float const * y, float const * z, size_t count, float * out_x, float * out_y, float * out_z, float * out_w ) {
+      auto const & m = matrix.Data;
+      FloatN elements[16];
+      for( size_t i = 0; i < 16; ++i ) {
+        elements[i] = SplatN( m[i] );
+      }
+
+      size_t i = 0;
+      for( ; i + SimdWidth <= count; i += SimdWidth ) {
+        FloatN point_x = LoadN( x + i );
+        FloatN point_y = LoadN( y + i );
+        FloatN point_z = LoadN( z + i );
+        StoreN( out_x + i, MulAddN( elements[8], point_z, MulAddN( elements[4], point_y, MulAddN( elements[0], point_x, elements[12] ) ) ) );
+        StoreN( out_y + i, MulAddN( elements[9], point_z, MulAddN( elements[5], point_y, MulAddN( elements[1], point_x, elements[13] ) ) ) );
+        StoreN( out_z + i, MulAddN( elements[10], point_z, MulAddN( elements[6], point_y, MulAddN( elements[2], point_x, elements[14] ) ) ) );
+        StoreN( out_w + i, MulAddN( elements[11], point_z, MulAddN( elements[7], point_y, MulAddN( elements[3], point_x, elements[15] ) ) ) );
+      }
+      Scalar::TransformPoints( matrix, x + i, y + i, z + i, count - i, out_x + i, out_y + i, out_z + i, out_w + i );
+    }
+
+    size_t CullSpheres( Frustum const & frustum, float const * x, float const * y, float const * z, float const * radius, size_t count, uint32_t * visible_indices ) {
+      FloatN planes[6][4];
+      for( size_t p = 0; p < 6; ++p ) {
+        planes[p][0] = SplatN( frustum.Planes[p].X );
+        planes[p][1] = SplatN( frustum.Planes[p].Y );
+        planes[p][2] = SplatN( frustum.Planes[p].Z );
+        planes[p][3] = SplatN( frustum.Planes[p].W );
+      }
+      FloatN zero = SplatN( 0.0f );
+
+      size_t visible_count = 0;
+      size_t i = 0;
+      for( ; i + SimdWidth <= count; i += SimdWidth ) {
+        FloatN center_x = LoadN( x + i );
+        FloatN center_y = LoadN( y + i );
+        FloatN center_z = LoadN( z + i );
+        FloatN sphere_radius = LoadN( radius + i );
+
+        MaskN visible = GreaterEqualN( AddN( MulAddN( planes[0][2], center_z, MulAddN( planes[0][1], center_y, MulAddN( planes[0][0], center_x, planes[0][3] ) ) ), sphere_radius ), zero );
+        for( size_t p = 1; p < 6; ++p ) {
+          FloatN distance = MulAddN( planes[p][2], center_z, MulAddN( planes[p][1], center_y, MulAddN( planes[p][0], center_x, planes[p][3] ) ) );
+          visible = AndN( visible, GreaterEqualN( AddN( distance, sphere_radius ), zero ) );
+        }
+
+        // Indices of visible spheres are compacted
+        uint32_t bits = GetMaskBits( visible );
+        for( size_t b = 0; bits != 0; ++b, bits >>= 1 ) {
+          if( bits & 1 ) {
+            visible_indices[visible_count++] = static_cast<uint32_t>(i + b);
+          }
+        }
+      }
+
+      size_t remaining_count = Scalar::CullSpheres( frustum, x + i, y + i, z + i, radius + i, count - i, visible_indices + visible_count );
+      for( size_t j = visible_count; j < visible_count + remaining_count; ++j ) {
+        visible_indices[j] += static_cast<uint32_t>(i);
+      }
+      return visible_count + remaining_count;
+    }
+
+    namespace Scalar {
+
+      Mat4 Multiply( Mat4 const & left, Mat4 const & right ) {
+        Mat4 result;
+        for( int column = 0; column < 4; ++column ) {
+          for( int row = 0; row < 4; ++row ) {
+            float sum = 0.0f;
+            for( int k = 0; k < 4; ++k ) {
+              sum += left.Data[4 * k + row] * right.Data[4 * column + k];
+            }
+            result.Data[4 * column + row] = sum;
+          }
+        }
+        return result;
+      }
+
+      Vec4 Transform( Mat4 const & matrix, Vec4 const & vector ) {
+        auto const & m = matrix.Data;
+        return Vec4(
+          m[0] * vector.X + m[4] * vector.Y + m[8]  * vector.Z + m[12] * vector.W,
+          m[1] * vector.X + m[5] * vector.Y + m[9]  * vector.Z + m[13] * vector.W,
+          m[2] * vector.X + m[6] * vector.Y + m[10] * vector.Z + m[14] * vector.W,
+          m[3] * vector.X + m[7] * vector.Y + m[11] * vector.Z + m[15] * vector.W
+        );
+      }
+
+      void TransformPoints( Mat4 const & matrix, float const * x, float const * y, float const * z, size_t count, float * out_x, float * out_y, float * out_z, float * out_w ) {
+        auto const & m = matrix.Data;
+        for( size_t i = 0; i < count; ++i ) {
+          out_x[i] = m[0] * x[i] + m[4] * y[i] + m[8]  * z[i] + m[12];
+          out_y[i] = m[1] * x[i] + m[5] * y[i] + m[9]  * z[i] + m[13];
+          out_z[i] = m[2] * x[i] + m[6] * y[i] + m[10] * z[i] + m[14];
+          out_w[i] = m[3] * x[i] + m[7] * y[i] + m[11] * z[i] + m[15];
+        }
+      }
+
+      size_t CullSpheres( Frustum const & frustum, float const * x, float const * y, float const * z, float const * radius, size_t count, uint32_t * visible_indices ) {
+        size_t visible_count = 0;
+        for( size_t i = 0; i < count; ++i ) {
+          if( IsSphereInFrustum( frustum, Vec4( x[i], y[i], z[i], 1.0f ), radius[i] ) ) {
+            visible_indices[visible_count++] = static_cast<uint32_t>(i);
+          }
+        }
+        return visible_count;
+      }
+
+    } // namespace Scalar
+
+    BenchmarkResults RunBenchmark( size_t points_count, uint32_t iterations_count ) {
+      static const size_t matrices_count = 1024;
+
+      // Same random data is used by both implementations
+      std::mt19937 generator( 1 );
+      std::uniform_real_distribution<float> position( -100.0f, 100.0f );
+      std::uniform_real_distribution<float> size( 0.5f, 2.0f );
+
+      std::vector<float> x( points_count ), y( points_count ), z( points_count ), radius( points_count );
+      for( size_t i = 0; i < points_count; ++i ) {
+        x[i] = position( generator );
+        y[i] = position( generator );
+        z[i] = position( generator );
+        radius[i] = size( generator );
+      }
+      std::vector<Mat4> matrices( matrices_count );
+      for( auto & matrix : matrices ) {
+        for( auto & element : matrix.Data ) {
+          element = size( generator );
+        }
+      }
+
+      Mat4 view = Mat4::Identity();
+      view.Data[14] = -100.0f;
+      Mat4 projection( { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0005f, -1.0f, 0.0f, 0.0f, -0.10005f, 0.0f } );
+      Mat4 view_projection = Multiply( projection, view );
+      Frustum frustum = GetFrustum( view_projection );
+
+      std::vector<float> scalar_results( 4 * points_count ), simd_results( 4 * points_count );
+      std::vector<uint32_t> scalar_indices( points_count ), simd_indices( points_count );
+      std::vector<Mat4> scalar_products( matrices_count ), simd_products( matrices_count );
+      size_t scalar_visible_count = 0;
+      size_t simd_visible_count = 0;
+
+      auto measure = [iterations_count]( std::function<void()> const & function ) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for( uint32_t i = 0; i < iterations_count; ++i ) {
+          function();
+        }
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time);
+        return static_cast<float>(time.count() * 0.001f) / iterations_count;
+      };
+
+      BenchmarkResults results;
+      results.PointsCount = points_count;
+      results.ScalarMultiplyTime = measure( [&]() {
+        for( size_t i = 0; i < matrices_count; ++i ) {
+          scalar_products[i] = Scalar::Multiply( matrices[i], matrices[(i + 1) % matrices_count] );
+        }
+      } );
+      results.SimdMultiplyTime = measure( [&]() {
+        for( size_t i = 0; i < matrices_count; ++i ) {
+          simd_products[i] = Multiply( matrices[i], matrices[(i + 1) % matrices_count] );
+        }
+      } );
+      results.ScalarTransformTime = measure( [&]() {
+        Scalar::TransformPoints( view_projection, x.data(), y.data(), z.data(), points_count, &scalar_results[0], &scalar_results[points_count], &scalar_results[2 * points_count], &scalar_results[3 * points_count] );
+      } );
+      results.SimdTransformTime = measure( [&]() {
+        TransformPoints( view_projection, x.data(), y.data(), z.data(), points_count, &simd_results[0], &simd_results[points_count], &simd_results[2 * points_count], &simd_results[3 * points_count] );
+      } );
+      results.ScalarCullingTime = measure( [&]() {
+        scalar_visible_count = Scalar::CullSpheres( frustum, x.data(), y.data(), z.data(), radius.data(), points_count, scalar_indices.data() );
+      } );
+      results.SimdCullingTime = measure( [&]() {
+        simd_visible_count = CullSpheres( frustum, x.data(), y.data(), z.data(), radius.data(), points_count, simd_indices.data() );
+      } );
+
+      // Fused multiply-add may change results slightly so a tolerance is used; spheres found visible by only one
+      // implementation are accepted (and counted separately) when they lie on a frustum's boundary
+      results.ResultsMatch = true;
+      size_t scalar_index = 0;
+      size_t simd_index = 0;
+      while( results.ResultsMatch && ((scalar_index < scalar_visible_count) || (simd_index < simd_visible_count)) ) {
+        uint32_t scalar_visible = (scalar_index < scalar_visible_count) ? scalar_indices[scalar_index] : UINT32_MAX;
+        uint32_t simd_visible = (simd_index < simd_visible_count) ? simd_indices[simd_index] : UINT32_MAX;
+        if( scalar_visible == simd_visible ) {
+          ++scalar_index;
+          ++simd_index;
+          continue;
+        }
+        uint32_t index = std::min( scalar_visible, simd_visible );
+        if( !IsSphereOnFrustumBoundary( frustum, x[index], y[index], z[index], radius[index] ) ) {
+          results.ResultsMatch = false;
+          break;
+        }
+        ++results.BoundaryMismatchesCount;
+        if( scalar_visible < simd_visible ) {
+          ++scalar_index;
+        } else {
+          ++simd_index;
+        }
+      }
+      for( size_t i = 0; results.ResultsMatch && (i < scalar_results.size()); ++i ) {
+        results.ResultsMatch = std::abs( scalar_results[i] - simd_results[i] ) <= 0.001f * (1.0f + std::abs( scalar_results[i] ));
+      }
+      for( size_t i = 0; results.ResultsMatch && (i < matrices_count); ++i ) {
+        for( size_t j = 0; results.ResultsMatch && (j < 16); ++j ) {
+          results.ResultsMatch = std::abs( scalar_products[i].Data[j] - simd_products[i].Data[j] ) <= 0.001f * (1.0f + std::abs( scalar_products[i].Data[j] ));
+        }
+      }
+      return results;
+    }
+
+  } // namespace Math
+
+} // namespace ApiWithoutSecrets
@@ -0,0 +1,180 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(SIMD_MATH_HEADER)
+#define SIMD_MATH_HEADER
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ApiWithoutSecrets {
+
+  namespace Math {
+
+    // ************************************************************ //
+    // Vec4                                                         //
+    //                                                              //
+    // Four-component vector aligned for SIMD loads                 //
+    // ************************************************************ //
+    struct alignas(16) Vec4 {
+      float   X;
+      float   Y;
+      float   Z;
+      float   W;
+
+      Vec4() :
+        X( 0.0f ),
+        Y( 0.0f ),
+        Z( 0.0f ),
+        W( 0.0f ) {
+      }
+
+      Vec4( float x, float y, float z, float w ) :
+        X( x ),
+        Y( y ),
+        Z( z ),
+        W( w ) {
+      }
+    };
+
+    // ************************************************************ //
+    // Mat4                                                         //
+    //                                                              //
+    // Column-major 4x4 matrix aligned for SIMD loads; layout is    //
+    // the same as in matrices returned by Tools and in GLSL        //
+    // ************************************************************ //
+    struct alignas(16) Mat4 {
+      std::array<float, 16>   Data;
+
+      Mat4() :
+        Data() {
+      }
+
+      explicit Mat4( std::array<float, 16> const & data ) :
+        Data( data ) {
+      }
+
+      static Mat4 Identity();
+    };
+
+    // ************************************************************ //
+    // Frustum                                                      //
+    //                                                              //
+    // Normalized left, right, bottom, top, near and far planes;    //
+    // points for which dot( plane.xyz, point ) + plane.w >= 0 are  //
+    // on the inner side of a plane                                 //
+    // ************************************************************ //
+    struct Frustum {
+      std::array<Vec4, 6>     Planes;
+
+      Frustum() :
+        Planes() {
+      }
+    };
+
+    // ************************************************************ //
+    // GetInstructionSet                                            //
+    //                                                              //
+    // Name of the instruction set used by batched kernels; AVX2 is //
+    // used when enabled during compilation, otherwise SSE or NEON  //
+    // with a scalar fallback for other architectures               //
+    // ************************************************************ //
+    char const * GetInstructionSet();
+
+    Mat4    Multiply( Mat4 const & left, Mat4 const & right );
+    Vec4    Transform( Mat4 const & matrix, Vec4 const & vector );
+    Mat4    Transpose( Mat4 const & matrix );
+    Mat4    Inverse( Mat4 const & matrix );
+
+    // ************************************************************ //
+    // GetFrustum                                                   //
+    //                                                              //
+    // Function extracting frustum planes from a (view) projection  //
+    // matrix which uses Vulkan's clip space with depth in [0, 1]   //
+    // ************************************************************ //
+    Frustum GetFrustum( Mat4 const & view_projection );
+    bool    IsSphereInFrustum( Frustum const & frustum, Vec4 const & center, float radius );
+    bool    IsAabbInFrustum( Frustum const & frustum, Vec4 const & min, Vec4 const & max );
+
+    // ************************************************************ //
+    // TransformPoints                                              //
+    //                                                              //
+    // Batched transformation of points stored as separate arrays   //
+    // of coordinates (w = 1); results are stored in the same way   //
+    // ************************************************************ //
+    void    TransformPoints( Mat4 const & matrix, float const * x, float const * y, float const * z, size_t count, float * out_x, float * out_y, float * out_z, float * out_w );
+
+    // ************************************************************ //
+    // CullSpheres                                                  //
+    //                                                              //
+    // Batched frustum test of spheres stored as separate arrays;   //
+    // indices of visible spheres are written in ascending order    //
+    // and their number is returned                                 //
+    // ************************************************************ //
+    size_t  CullSpheres( Frustum const & frustum, float const * x, float const * y, float const * z, float const * radius, size_t count, uint32_t * visible_indices );
+
+    // Reference implementations used for validation and comparison
+    namespace Scalar {
+      Mat4    Multiply( Mat4 const & left, Mat4 const & right );
+      Vec4    Transform( Mat4 const & matrix, Vec4 const & vector );
+      void    TransformPoints( Mat4 const & matrix, float const * x, float const * y, float const * z, size_t count, float * out_x, float * out_y, float * out_z, float * out_w );
+      size_t  CullSpheres( Frustum const & frustum, float const * x, float const * y, float const * z, float const * radius, size_t count, uint32_t * visible_indices );
+    } // namespace Scalar
+
+    // ************************************************************ //
+    // BenchmarkResults                                             //
+    //                                                              //
+    // Times (in milliseconds) of scalar and SIMD implementations   //
+    // ************************************************************ //
+    struct BenchmarkResults {
+      size_t    PointsCount;
+      float     ScalarMultiplyTime;
+      float     SimdMultiplyTime;
+      float     ScalarTransformTime;
+      float     SimdTransformTime;
+      float     ScalarCullingTime;
+      float     SimdCullingTime;
+      bool      ResultsMatch;
+      size_t    BoundaryMismatchesCount;  // <- Spheres culled differently because they lie on a frustum's plane
+
+      BenchmarkResults() :
+        PointsCount( 0 ),
+        ScalarMultiplyTime( 0.0f ),
+        SimdMultiplyTime( 0.0f ),
+        ScalarTransformTime( 0.0f ),
+        SimdTransformTime( 0.0f ),
+        ScalarCullingTime( 0.0f ),
+        SimdCullingTime( 0.0f ),
+        ResultsMatch( false ),
+        BoundaryMismatchesCount( 0 ) {
+      }
+    };
+
+    // ************************************************************ //
+    // RunBenchmark                                                 //
+    //                                                              //
+    // Micro-benchmark comparing SIMD kernels with scalar code on   //
+    // the same randomly generated data                             //
+    // ************************************************************ //
+    BenchmarkResults RunBenchmark( size_t points_count, uint32_t iterations_count );
+
+  } // namespace Math
+
+} // namespace ApiWithoutSecrets
+
+#endif // SIMD_MATH_HEADER
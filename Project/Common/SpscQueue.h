@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#if !defined(SPSC_QUEUE_HEADER)
+#define SPSC_QUEUE_HEADER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ApiWithoutSecrets {
+
+  // ************************************************************ //
+  // SpscQueue                                                    //
+  //                                                              //
+  // Bounded lock-free queue for a single producer thread and a   //
+  // single consumer thread; indices are kept on separate cache   //
+  // lines so both threads don't invalidate each other's data     //
+  // ************************************************************ //
+  template<class T, size_t Capacity>
+  class SpscQueue {
+  public:
+    bool    Push( T const & item );
+    bool    Pop( T & item );
+    bool    IsEmpty() const;
+
+    SpscQueue();
+
+  private:
+    alignas(64) std::atomic<uint64_t>   Head;     // <- Index of a next item to pop, written only by the consumer
+    alignas(64) std::atomic<uint64_t>   Tail;     // <- Index of a next item to push, written only by the producer
+    alignas(64) std::array<T, Capacity> Items;
+  };
+
+  template<class T, size_t Capacity>
+  SpscQueue<T, Capacity>::SpscQueue() :
+    Head( 0 ),
+    Tail( 0 ),
+    Items() {
+  }
+
+  template<class T, size_t Capacity>
+  bool SpscQueue<T, Capacity>::Push( T const & item ) {
+    uint64_t tail = Tail.load( std::memory_order_relaxed );
+    if( tail - Head.load( std::memory_order_acquire ) >= Capacity ) {
+      return false;
+    }
+    Items[tail % Capacity] = item;
+    // Item is published together with the new tail
+    Tail.store( tail + 1, std::memory_order_release );
+    return true;
+  }
+
+  template<class T, size_t Capacity>
+  bool SpscQueue<T, Capacity>::Pop( T & item ) {
+    uint64_t head = Head.load( std::memory_order_relaxed );
+    if( head == Tail.load( std::memory_order_acquire ) ) {
+      return false;
+    }
+    item = Items[head % Capacity];
+    // Slot may be reused by the producer after the new head is visible
+    Head.store( head + 1, std::memory_order_release );
+    return true;
+  }
+
+  template<class T, size_t Capacity>
+  bool SpscQueue<T, Capacity>::IsEmpty() const {
+    return Head.load( std::memory_order_acquire ) == Tail.load( std::memory_order_acquire );
+  }
+
+} // namespace ApiWithoutSecrets
+
+#endif // SPSC_QUEUE_HEADER
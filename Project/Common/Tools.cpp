@@ -14,6 +14,7 @@
 // under the License.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <iostream>
@@ -50,6 +51,16 @@ namespace ApiWithoutSecrets {
       return result;
     }
 
+    // ************************************************************ //
+    // FileExists                                                   //
+    //                                                              //
+    // Function checking whether a file can be opened for reading   //
+    // ************************************************************ //
+    bool FileExists( std::string const &filename ) {
+      std::ifstream file( filename, std::ios::binary );
+      return !file.fail();
+    }
+
     // ************************************************************ //
     // GetImageData                                                 //
     //                                                              //
@@ -91,6 +102,156 @@ namespace ApiWithoutSecrets {
       return output;
     }
 
+    // ************************************************************ //
+    // GetMipLevelsCount                                            //
+    //                                                              //
+    // Function calculating number of levels in a full mip chain    //
+    // ************************************************************ //
+    uint32_t GetMipLevelsCount( uint32_t width, uint32_t height ) {
+      uint32_t mip_levels = 1;
+      uint32_t size = std::max( width, height );
+      while( size > 1 ) {
+        size >>= 1;
+        ++mip_levels;
+      }
+      return mip_levels;
+    }
+
+    // ************************************************************ //
+    // GenerateMipmapsData                                          //
+    //                                                              //
+    // Function downsampling 4-component, 8-bit image data on the   //
+    // CPU; levels are stored one after another starting from the  //
+    // base level and their offsets are returned in level_offsets   //
+    // ************************************************************ //
+    std::vector<char> GenerateMipmapsData( char const * data, uint32_t width, uint32_t height, uint32_t mip_levels, std::vector<uint32_t> & level_offsets ) {
+      level_offsets.resize( mip_levels );
+
+      uint32_t total_size = 0;
+      for( uint32_t level = 0; level < mip_levels; ++level ) {
+        level_offsets[level] = total_size;
+        total_size += std::max( width >> level, 1u ) * std::max( height >> level, 1u ) * 4;
+      }
+
+      std::vector<char> output( total_size );
+      memcpy( &output[0], data, width * height * 4 );
+
+      for( uint32_t level = 1; level < mip_levels; ++level ) {
+        uint32_t src_width = std::max( width >> (level - 1), 1u );
+        uint32_t src_height = std::max( height >> (level - 1), 1u );
+        uint32_t dst_width = std::max( width >> level, 1u );
+        uint32_t dst_height = std::max( height >> level, 1u );
+
+        unsigned char const * src = reinterpret_cast<unsigned char const *>(&output[level_offsets[level - 1]]);
+        unsigned char * dst = reinterpret_cast<unsigned char *>(&output[level_offsets[level]]);
+
+        // 2x2 box filter; odd dimensions reuse the last row/column
+        for( uint32_t y = 0; y < dst_height; ++y ) {
+          uint32_t y0 = std::min( 2 * y, src_height - 1 );
+          uint32_t y1 = std::min( 2 * y + 1, src_height - 1 );
+          for( uint32_t x = 0; x < dst_width; ++x ) {
+            uint32_t x0 = std::min( 2 * x, src_width - 1 );
+            uint32_t x1 = std::min( 2 * x + 1, src_width - 1 );
+            for( uint32_t c = 0; c < 4; ++c ) {
+              uint32_t sum = src[(y0 * src_width + x0) * 4 + c] +
+                             src[(y0 * src_width + x1) * 4 + c] +
+                             src[(y1 * src_width + x0) * 4 + c] +
+                             src[(y1 * src_width + x1) * 4 + c];
+              dst[(y * dst_width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+          }
+        }
+      }
+
+      return output;
+    }
+
+    // ************************************************************ //
+    // GetKTX2ImageData                                             //
+    //                                                              //
+    // Function loading 2D image data (optionally block-compressed  //
+    // and with a mip chain) from a KTX2 file; supercompressed      //
+    // files, arrays, cubemaps and 3D images are not supported      //
+    // ************************************************************ //
+    KTX2ImageData GetKTX2ImageData( std::string const &filename ) {
+      static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+      struct Header {
+        uint32_t  VkFormat;
+        uint32_t  TypeSize;
+        uint32_t  PixelWidth;
+        uint32_t  PixelHeight;
+        uint32_t  PixelDepth;
+        uint32_t  LayerCount;
+        uint32_t  FaceCount;
+        uint32_t  LevelCount;
+        uint32_t  SupercompressionScheme;
+        uint32_t  DfdByteOffset;
+        uint32_t  DfdByteLength;
+        uint32_t  KvdByteOffset;
+        uint32_t  KvdByteLength;
+        uint64_t  SgdByteOffset;
+        uint64_t  SgdByteLength;
+      } header;
+
+      struct LevelIndex {
+        uint64_t  ByteOffset;
+        uint64_t  ByteLength;
+        uint64_t  UncompressedByteLength;
+      };
+
+      std::vector<char> file_data = Tools::GetBinaryFileContents( filename );
+      if( (file_data.size() < sizeof( identifier ) + sizeof( Header )) ||
+          (memcmp( &file_data[0], identifier, sizeof( identifier ) ) != 0) ) {
+        throw std::exception( std::string( "\"" + filename + "\" is not a valid KTX2 file!" ).c_str() );
+      }
+      memcpy( &header, &file_data[sizeof( identifier )], sizeof( Header ) );
+
+      if( (header.VkFormat == VK_FORMAT_UNDEFINED) ||
+          (header.PixelWidth == 0) ||
+          (header.PixelHeight == 0) ||
+          (header.PixelDepth > 1) ||
+          (header.LayerCount > 1) ||
+          (header.FaceCount != 1) ||
+          (header.SupercompressionScheme != 0) ) {
+        throw std::exception( std::string( "Unsupported type of image data in \"" + filename + "\" file!" ).c_str() );
+      }
+
+      // Level count equal to 0 means that mipmaps should be generated by the application
+      uint32_t level_count = std::max( header.LevelCount, 1u );
+      size_t level_index_offset = sizeof( identifier ) + sizeof( Header );
+      if( file_data.size() < level_index_offset + level_count * sizeof( LevelIndex ) ) {
+        throw std::exception( std::string( "\"" + filename + "\" is not a valid KTX2 file!" ).c_str() );
+      }
+      std::vector<LevelIndex> levels( level_count );
+      memcpy( &levels[0], &file_data[level_index_offset], level_count * sizeof( LevelIndex ) );
+
+      KTX2ImageData image;
+      image.Format = static_cast<vk::Format>(header.VkFormat);
+      image.Width = header.PixelWidth;
+      image.Height = header.PixelHeight;
+      image.MipLevels = level_count;
+      image.GenerateMipmaps = header.LevelCount == 0;
+      image.LevelOffsets.resize( level_count );
+
+      // Files store the smallest level first; repack levels starting from the base one
+      uint64_t total_size = 0;
+      for( uint32_t i = 0; i < level_count; ++i ) {
+        if( levels[i].ByteOffset + levels[i].ByteLength > file_data.size() ) {
+          throw std::exception( std::string( "\"" + filename + "\" is not a valid KTX2 file!" ).c_str() );
+        }
+        image.LevelOffsets[i] = static_cast<uint32_t>(total_size);
+        total_size += levels[i].ByteLength;
+      }
+
+      image.Data.resize( static_cast<size_t>(total_size) );
+      for( uint32_t i = 0; i < level_count; ++i ) {
+        memcpy( &image.Data[image.LevelOffsets[i]], &file_data[static_cast<size_t>(levels[i].ByteOffset)], static_cast<size_t>(levels[i].ByteLength) );
+      }
+
+      return image;
+    }
+
     // ************************************************************ //
     // GetPerspectiveProjectionMatrix                               //
     //                                                              //
@@ -91,6 +91,13 @@ namespace ApiWithoutSecrets {
     // ************************************************************ //
     std::vector<char> GetBinaryFileContents( std::string const &filename );
 
+    // ************************************************************ //
+    // FileExists                                                   //
+    //                                                              //
+    // Function checking whether a file can be opened for reading   //
+    // ************************************************************ //
+    bool FileExists( std::string const &filename );
+
     // ************************************************************ //
     // GetImageData                                                 //
     //                                                              //
@@ -98,6 +105,58 @@ namespace ApiWithoutSecrets {
     // ************************************************************ //
     std::vector<char> GetImageData( std::string const &filename, int requested_components, int *width, int *height, int *components, int *data_size );
 
+    // ************************************************************ //
+    // GetMipLevelsCount                                            //
+    //                                                              //
+    // Function calculating number of levels in a full mip chain    //
+    // ************************************************************ //
+    uint32_t GetMipLevelsCount( uint32_t width, uint32_t height );
+
+    // ************************************************************ //
+    // GenerateMipmapsData                                          //
+    //                                                              //
+    // Function downsampling 4-component, 8-bit image data on the   //
+    // CPU; levels are stored one after another starting from the  //
+    // base level and their offsets are returned in level_offsets   //
+    // ************************************************************ //
+    std::vector<char> GenerateMipmapsData( char const * data, uint32_t width, uint32_t height, uint32_t mip_levels, std::vector<uint32_t> & level_offsets );
+
+    // ************************************************************ //
+    // KTX2ImageData                                                //
+    //                                                              //
+    // Struct containing image data read from a KTX2 container;     //
+    // levels are stored one after another starting from the base  //
+    // level and their offsets are stored in LevelOffsets           //
+    // ************************************************************ //
+    struct KTX2ImageData {
+      vk::Format              Format;
+      uint32_t                Width;
+      uint32_t                Height;
+      uint32_t                MipLevels;
+      bool                    GenerateMipmaps;    // <- Only the base level is stored, the rest should be generated
+      std::vector<char>       Data;
+      std::vector<uint32_t>   LevelOffsets;
+
+      KTX2ImageData() :
+        Format( vk::Format::eUndefined ),
+        Width( 0 ),
+        Height( 0 ),
+        MipLevels( 0 ),
+        GenerateMipmaps( false ),
+        Data(),
+        LevelOffsets() {
+      }
+    };
+
+    // ************************************************************ //
+    // GetKTX2ImageData                                             //
+    //                                                              //
+    // Function loading 2D image data (optionally block-compressed  //
+    // and with a mip chain) from a KTX2 file; supercompressed      //
+    // files, arrays, cubemaps and 3D images are not supported      //
+    // ************************************************************ //
+    KTX2ImageData GetKTX2ImageData( std::string const &filename );
+
     // ************************************************************ //
     // GetPerspectiveProjectionMatrix                               //
     //                                                              //
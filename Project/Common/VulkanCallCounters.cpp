@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "VulkanCallCounters.h"
+
+#if defined(VULKAN_CALL_COUNTERS)
+
+#include <algorithm>
+#include <cstring>
+
+namespace ApiWithoutSecrets {
+
+  namespace CallCounters {
+
+    PFN_vkVoidFunction     RealFunctions[static_cast<size_t>(FunctionIndex::Count)];
+    std::atomic<uint32_t>  CurrentFrameCounts[static_cast<size_t>(FunctionIndex::Count)];
+
+    namespace {
+
+      char const * const FunctionNames[] = {
+#define VK_EXPORTED_FUNCTION( fun ) #fun,
+#define VK_GLOBAL_LEVEL_FUNCTION( fun, ver ) #fun,
+#define VK_INSTANCE_LEVEL_FUNCTION( fun, ver ) #fun,
+#define VK_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION( fun, ext ) #fun,
+#define VK_DEVICE_LEVEL_FUNCTION( fun, ver ) #fun,
+#define VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( fun, ext ) #fun,
+
+#include "ListOfFunctions.inl"
+
+        ""
+      };
+
+      std::vector<EntryData>  LastFrameEntries;
+      uint32_t                LastFrameTotalCount = 0;
+      uint32_t                LastFrameObjectLifetimeCount = 0;
+
+      bool IsObjectLifetimeFunction( char const * name ) {
+        static char const * const prefixes[] = { "vkCreate", "vkDestroy", "vkAllocate", "vkFree" };
+        for( auto prefix : prefixes ) {
+          if( std::strncmp( name, prefix, std::strlen( prefix ) ) == 0 ) {
+            return true;
+          }
+        }
+        return false;
+      }
+
+    } // namespace
+
+    void FinishFrame() {
+      LastFrameEntries.clear();
+      LastFrameTotalCount = 0;
+      LastFrameObjectLifetimeCount = 0;
+
+      for( size_t i = 0; i < static_cast<size_t>(FunctionIndex::Count); ++i ) {
+        uint32_t count = CurrentFrameCounts[i].exchange( 0, std::memory_order_relaxed );
+        if( count == 0 ) {
+          continue;
+        }
+
+        bool object_lifetime = IsObjectLifetimeFunction( FunctionNames[i] );
+        LastFrameEntries.push_back( { FunctionNames[i], count, object_lifetime } );
+        LastFrameTotalCount += count;
+        if( object_lifetime ) {
+          LastFrameObjectLifetimeCount += count;
+        }
+      }
+
+      std::sort( LastFrameEntries.begin(), LastFrameEntries.end(), []( EntryData const & left, EntryData const & right ) {
+        return left.Count > right.Count;
+      } );
+    }
+
+    std::vector<EntryData> const & GetLastFrameEntries() {
+      return LastFrameEntries;
+    }
+
+    uint32_t GetLastFrameTotalCount() {
+      return LastFrameTotalCount;
+    }
+
+    uint32_t GetLastFrameObjectLifetimeCount() {
+      return LastFrameObjectLifetimeCount;
+    }
+
+  } // namespace CallCounters
+
+} // namespace ApiWithoutSecrets
+
+#endif // VULKAN_CALL_COUNTERS
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(VULKAN_CALL_COUNTERS_HEADER)
+#define VULKAN_CALL_COUNTERS_HEADER
+
+#include "vulkan.hpp"
+#include "VulkanExtensions.h"
+
+#if defined(VULKAN_CALL_COUNTERS)
+
+#include <atomic>
+#include <vector>
+
+namespace ApiWithoutSecrets {
+
+  namespace CallCounters {
+
+    // ************************************************************ //
+    // FunctionIndex                                                //
+    //                                                              //
+    // Index of each function from the ListOfFunctions.inl file     //
+    // ************************************************************ //
+    enum class FunctionIndex : size_t {
+#define VK_EXPORTED_FUNCTION( fun ) fun,
+#define VK_GLOBAL_LEVEL_FUNCTION( fun, ver ) fun,
+#define VK_INSTANCE_LEVEL_FUNCTION( fun, ver ) fun,
+#define VK_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION( fun, ext ) fun,
+#define VK_DEVICE_LEVEL_FUNCTION( fun, ver ) fun,
+#define VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( fun, ext ) fun,
+
+#include "ListOfFunctions.inl"
+
+      Count
+    };
+
+    // ************************************************************ //
+    // EntryData                                                    //
+    //                                                              //
+    // Number of calls of a single function                         //
+    // ************************************************************ //
+    struct EntryData {
+      char const *  Name;
+      uint32_t      Count;
+      bool          ObjectLifetime;   // <- Creation, allocation or destruction of an object
+    };
+
+    extern PFN_vkVoidFunction     RealFunctions[static_cast<size_t>(FunctionIndex::Count)];
+    extern std::atomic<uint32_t>  CurrentFrameCounts[static_cast<size_t>(FunctionIndex::Count)];
+
+    // ************************************************************ //
+    // Wrapper                                                      //
+    //                                                              //
+    // Function counting calls and forwarding them to the function  //
+    // loaded from a Vulkan library                                 //
+    // ************************************************************ //
+    template<size_t Index, typename F>
+    struct Wrapper;
+
+    template<size_t Index, typename R, typename... Args>
+    struct Wrapper<Index, R (VKAPI_PTR *)( Args... )> {
+      static R VKAPI_PTR Call( Args... args ) {
+        CurrentFrameCounts[Index].fetch_add( 1, std::memory_order_relaxed );
+        return reinterpret_cast<R (VKAPI_PTR *)( Args... )>(RealFunctions[Index])( args... );
+      }
+    };
+
+    // ************************************************************ //
+    // Wrap                                                         //
+    //                                                              //
+    // Function storing loaded function and returning its wrapper   //
+    // ************************************************************ //
+    template<size_t Index, typename F>
+    F Wrap( F function ) {
+      RealFunctions[Index] = reinterpret_cast<PFN_vkVoidFunction>(function);
+      return &Wrapper<Index, F>::Call;
+    }
+
+    // ************************************************************ //
+    // FinishFrame                                                  //
+    //                                                              //
+    // Function storing counts gathered during the current frame    //
+    // and resetting counters for a next frame                      //
+    // ************************************************************ //
+    void FinishFrame();
+
+    // ************************************************************ //
+    // GetLastFrameEntries                                          //
+    //                                                              //
+    // Function returning functions called during the last frame    //
+    // sorted from the most frequently called                       //
+    // ************************************************************ //
+    std::vector<EntryData> const & GetLastFrameEntries();
+
+    // ************************************************************ //
+    // GetLastFrameTotalCount                                       //
+    //                                                              //
+    // Function returning number of all calls in the last frame     //
+    // ************************************************************ //
+    uint32_t GetLastFrameTotalCount();
+
+    // ************************************************************ //
+    // GetLastFrameObjectLifetimeCount                              //
+    //                                                              //
+    // Function returning number of object creations, allocations  //
+    // and destructions in the last frame                           //
+    // ************************************************************ //
+    uint32_t GetLastFrameObjectLifetimeCount();
+
+  } // namespace CallCounters
+
+} // namespace ApiWithoutSecrets
+
+#define VK_COUNT_CALLS( fun )                                                                     \
+    if( fun != nullptr ) {                                                                        \
+      fun = CallCounters::Wrap<static_cast<size_t>(CallCounters::FunctionIndex::fun)>( fun );     \
+    }
+
+#else
+
+#define VK_COUNT_CALLS( fun )
+
+#endif // VULKAN_CALL_COUNTERS
+
+#endif // VULKAN_CALL_COUNTERS_HEADER
@@ -16,6 +16,7 @@
 
 #include "VulkanCommon.h"
 #include "VulkanFunctions.h"
+#include "VulkanCallCounters.h"
 
 namespace ApiWithoutSecrets {
 
@@ -42,15 +43,22 @@ namespace ApiWithoutSecrets {
       return;
     }
 
-    Vulkan.Device->waitIdle();
-
+    // Device is not idled here - old swapchain and resources which depend on it are retired
+    // and released only after frames which still use them are finished
     OnWindowSizeChanged_Pre();
-    CreateSwapChain();
+    CreateSwapChain( Vulkan.SwapChain.SelectedPresentMode, Vulkan.SwapChain.SelectedUsageFlags, Vulkan.SwapChain.SelectedImageCount );
     if( CanRender ) {
       OnWindowSizeChanged_Post();
     }
   }
 
+  void VulkanCommon::ChangeSwapChainPresentation( vk::PresentModeKHR const selected_present_mode, uint32_t const selected_image_count ) {
+    // Swapchain is recreated the same way as when window size changes, so frames in flight are not waited for
+    Vulkan.SwapChain.SelectedPresentMode = selected_present_mode;
+    Vulkan.SwapChain.SelectedImageCount = selected_image_count;
+    OnWindowSizeChanged();
+  }
+
   vk::PhysicalDevice const & VulkanCommon::GetPhysicalDevice() const {
     return Vulkan.PhysicalDevice;
   }
@@ -75,6 +83,32 @@ namespace ApiWithoutSecrets {
     return *Vulkan.PresentationSurface;
   }
 
+  bool VulkanCommon::IsPresentWaitEnabled() const {
+    return Vulkan.PresentWaitEnabled;
+  }
+
+  bool VulkanCommon::IsDescriptorIndexingEnabled() const {
+    return Vulkan.DescriptorIndexingEnabled;
+  }
+
+  bool VulkanCommon::IsDescriptorUpdateTemplateEnabled() const {
+    return Vulkan.DescriptorUpdateTemplateEnabled;
+  }
+
+  bool VulkanCommon::IsTextureCompressionEnabled( vk::Format format ) const {
+    // Block-compressed formats may be used only when a feature of their family is enabled
+    if( (format >= vk::Format::eBc1RgbUnormBlock) && (format <= vk::Format::eBc7SrgbBlock) ) {
+      return Vulkan.EnabledFeatures.textureCompressionBC == VK_TRUE;
+    }
+    if( (format >= vk::Format::eEtc2R8G8B8UnormBlock) && (format <= vk::Format::eEacR11G11SnormBlock) ) {
+      return Vulkan.EnabledFeatures.textureCompressionETC2 == VK_TRUE;
+    }
+    if( (format >= vk::Format::eAstc4x4UnormBlock) && (format <= vk::Format::eAstc12x12SrgbBlock) ) {
+      return Vulkan.EnabledFeatures.textureCompressionASTC_LDR == VK_TRUE;
+    }
+    return true;
+  }
+
   const SwapChainParameters & VulkanCommon::GetSwapChain() const {
     return Vulkan.SwapChain;
   }
@@ -95,7 +129,8 @@ namespace ApiWithoutSecrets {
 #define VK_EXPORTED_FUNCTION( fun )                                               \
     if( !(fun = (PFN_##fun)LoadProcAddress( VulkanLibrary, #fun )) ) {            \
       throw std::exception( "Could not load exported function: " #fun "!" );      \
-    }
+    }                                                                             \
+    VK_COUNT_CALLS( fun )
 
 #include "ListOfFunctions.inl"
   }
@@ -105,7 +140,8 @@ namespace ApiWithoutSecrets {
     if( (ver <= version) &&                                                       \
         !(fun = (PFN_##fun)Vulkan.Instance->getProcAddr( #fun )) ) {              \
       throw std::exception( "Could not load global level function: " #fun "!" );  \
-    }
+    }                                                                             \
+    VK_COUNT_CALLS( fun )
 
 #include "ListOfFunctions.inl"
   }
@@ -130,6 +166,11 @@ namespace ApiWithoutSecrets {
       }
     }
 
+    // Optional extension which allows checking whether features of newer device extensions are supported
+    if( CheckExtensionAvailability( VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, available_extensions ) ) {
+      extensions.emplace_back( VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME );
+    }
+
     vk::ApplicationInfo application_info(
       "API without Secrets: Introduction to Vulkan",  // const char               * pApplicationName
       VK_MAKE_VERSION( 1, 0, 0 ),                     // uint32_t                   applicationVersion
@@ -156,7 +197,8 @@ namespace ApiWithoutSecrets {
     if( (ver <= version) &&                                                             \
         !(fun = (PFN_##fun)Vulkan.Instance->getProcAddr( #fun )) ) {                    \
       throw std::exception( "Could not load instance level function: " #fun "!" );      \
-    }
+    }                                                                                   \
+    VK_COUNT_CALLS( fun )
 
 #define VK_INSTANCE_LEVEL_FUNCTION_FROM_EXTENSION( fun, ext )                           \
     for( auto & enabled_extension : enabled_extensions ) {                              \
@@ -165,6 +207,7 @@ namespace ApiWithoutSecrets {
         if( fun == nullptr ) {                                                          \
           throw std::exception( "Could not load instance level function: " #fun "!" );  \
         }                                                                               \
+        VK_COUNT_CALLS( fun )                                                           \
       }                                                                                 \
     }
 
@@ -248,6 +291,86 @@ namespace ApiWithoutSecrets {
       VK_KHR_SWAPCHAIN_EXTENSION_NAME
     };
 
+    // Texture compression features are enabled whenever they are available, so pre-compressed textures can be used
+    vk::PhysicalDeviceFeatures supported_features = Vulkan.PhysicalDevice.getFeatures();
+    Vulkan.EnabledFeatures = vk::PhysicalDeviceFeatures();
+    Vulkan.EnabledFeatures.textureCompressionETC2 = supported_features.textureCompressionETC2;
+    Vulkan.EnabledFeatures.textureCompressionASTC_LDR = supported_features.textureCompressionASTC_LDR;
+    Vulkan.EnabledFeatures.textureCompressionBC = supported_features.textureCompressionBC;
+
+    // Optional present id and present wait extensions allow measuring when presentation actually happens
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR,    // VkStructureType                    sType
+      nullptr,                                                      // void                              *pNext
+      VK_FALSE                                                      // VkBool32                           presentId
+    };
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR,  // VkStructureType                    sType
+      &present_id_features,                                         // void                              *pNext
+      VK_FALSE                                                      // VkBool32                           presentWait
+    };
+    Vulkan.PresentWaitEnabled = false;
+
+    // Optional descriptor indexing allows selecting textures from a large, partially filled array with a per-instance index
+    VkPhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features = {};
+    descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+    Vulkan.DescriptorIndexingEnabled = false;
+
+    // Optional descriptor update templates write all descriptors of a set from a single block of memory
+    Vulkan.DescriptorUpdateTemplateEnabled = version >= VK_MAKE_VERSION( 1, 1, 0 );
+    if( !Vulkan.DescriptorUpdateTemplateEnabled &&
+        CheckExtensionAvailability( VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, Vulkan.PhysicalDevice.enumerateDeviceExtensionProperties() ) ) {
+      extensions.emplace_back( VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME );
+      Vulkan.DescriptorUpdateTemplateEnabled = true;
+    }
+
+    if( vkGetPhysicalDeviceFeatures2KHR != nullptr ) {
+      auto available_extensions = Vulkan.PhysicalDevice.enumerateDeviceExtensionProperties();
+
+      if( CheckExtensionAvailability( VK_KHR_PRESENT_ID_EXTENSION_NAME, available_extensions ) &&
+          CheckExtensionAvailability( VK_KHR_PRESENT_WAIT_EXTENSION_NAME, available_extensions ) ) {
+        VkPhysicalDeviceFeatures2 features = {
+          VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,               // VkStructureType                    sType
+          &present_wait_features,                                     // void                              *pNext
+          {}                                                          // VkPhysicalDeviceFeatures           features
+        };
+        vkGetPhysicalDeviceFeatures2KHR( static_cast<VkPhysicalDevice>(Vulkan.PhysicalDevice), &features );
+
+        if( present_id_features.presentId &&
+            present_wait_features.presentWait ) {
+          extensions.emplace_back( VK_KHR_PRESENT_ID_EXTENSION_NAME );
+          extensions.emplace_back( VK_KHR_PRESENT_WAIT_EXTENSION_NAME );
+          Vulkan.PresentWaitEnabled = true;
+        }
+      }
+
+      if( CheckExtensionAvailability( VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME, available_extensions ) &&
+          CheckExtensionAvailability( VK_KHR_MAINTENANCE3_EXTENSION_NAME, available_extensions ) ) {
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT supported_descriptor_indexing_features = {};
+        supported_descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+        VkPhysicalDeviceFeatures2 features = {
+          VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,               // VkStructureType                    sType
+          &supported_descriptor_indexing_features,                    // void                              *pNext
+          {}                                                          // VkPhysicalDeviceFeatures           features
+        };
+        vkGetPhysicalDeviceFeatures2KHR( static_cast<VkPhysicalDevice>(Vulkan.PhysicalDevice), &features );
+
+        // Only features needed by a bindless texture array are enabled
+        if( supported_descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing &&
+            supported_descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind &&
+            supported_descriptor_indexing_features.descriptorBindingPartiallyBound &&
+            supported_descriptor_indexing_features.runtimeDescriptorArray ) {
+          descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+          descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+          descriptor_indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+          descriptor_indexing_features.runtimeDescriptorArray = VK_TRUE;
+          extensions.emplace_back( VK_KHR_MAINTENANCE3_EXTENSION_NAME );
+          extensions.emplace_back( VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME );
+          Vulkan.DescriptorIndexingEnabled = true;
+        }
+      }
+    }
+
     vk::DeviceCreateInfo device_create_info(
       vk::DeviceCreateFlags( 0 ),                       // VkDeviceCreateFlags                flags
       static_cast<uint32_t>(queue_create_infos.size()), // uint32_t                           queueCreateInfoCount
@@ -256,8 +379,18 @@ namespace ApiWithoutSecrets {
       nullptr,                                          // const char * const                *ppEnabledLayerNames
       static_cast<uint32_t>(extensions.size()),         // uint32_t                           enabledExtensionCount
       extensions.data(),                                // const char * const                *ppEnabledExtensionNames
-      nullptr                                           // const VkPhysicalDeviceFeatures    *pEnabledFeatures
+      &Vulkan.EnabledFeatures                           // const VkPhysicalDeviceFeatures    *pEnabledFeatures
     );
+    void * enabled_features = nullptr;
+    if( Vulkan.PresentWaitEnabled ) {
+      // Structures filled during the query enable both features
+      enabled_features = &present_wait_features;
+    }
+    if( Vulkan.DescriptorIndexingEnabled ) {
+      descriptor_indexing_features.pNext = enabled_features;
+      enabled_features = &descriptor_indexing_features;
+    }
+    device_create_info.pNext = enabled_features;
 
     Vulkan.Device = Vulkan.PhysicalDevice.createDeviceUnique( device_create_info );
     Vulkan.GraphicsQueue.FamilyIndex = selected_graphics_queue_family_index;
@@ -343,7 +476,8 @@ namespace ApiWithoutSecrets {
     if( (ver <= version) &&                                                                 \
         !(fun = (PFN_##fun)Vulkan.Device->getProcAddr( #fun )) ) {                          \
       throw std::exception( "Could not load device level function: " #fun "!" );            \
-    }
+    }                                                                                       \
+    VK_COUNT_CALLS( fun )
 
 #define VK_DEVICE_LEVEL_FUNCTION_FROM_EXTENSION( fun, ext )                                 \
     for( auto & enabled_extension : enabled_extensions ) {                                  \
@@ -352,10 +486,19 @@ namespace ApiWithoutSecrets {
         if( fun == nullptr ) {                                                              \
           throw std::exception( "Could not load device level Vulkan function: " #fun "!" ); \
         }                                                                                   \
+        VK_COUNT_CALLS( fun )                                                               \
       }                                                                                     \
     }
 
 #include "ListOfFunctions.inl"
+
+    // On Vulkan 1.0 update templates come from the extension; core entry points are redirected to it, so unique handles can destroy templates
+    if( (version < VK_MAKE_VERSION( 1, 1, 0 )) &&
+        (vkCreateDescriptorUpdateTemplateKHR != nullptr) ) {
+      vkCreateDescriptorUpdateTemplate = vkCreateDescriptorUpdateTemplateKHR;
+      vkDestroyDescriptorUpdateTemplate = vkDestroyDescriptorUpdateTemplateKHR;
+      vkUpdateDescriptorSetWithTemplate = vkUpdateDescriptorSetWithTemplateKHR;
+    }
   }
 
   void VulkanCommon::GetDeviceQueue() {
@@ -370,7 +513,7 @@ namespace ApiWithoutSecrets {
       return;
     }
 
-    Vulkan.Device->waitIdle();
+    std::vector<vk::UniqueImageView> old_image_views = std::move( Vulkan.SwapChain.ImageViews );
     Vulkan.SwapChain.Images.clear();
     Vulkan.SwapChain.ImageViews.clear();
 
@@ -378,6 +521,14 @@ namespace ApiWithoutSecrets {
     auto surface_formats = Vulkan.PhysicalDevice.getSurfaceFormatsKHR( *Vulkan.PresentationSurface );
     auto present_modes = Vulkan.PhysicalDevice.getSurfacePresentModesKHR( *Vulkan.PresentationSurface );
 
+    // Remember requested parameters so they are preserved when swapchain is recreated
+    Vulkan.SwapChain.SelectedPresentMode = selected_present_mode;
+    Vulkan.SwapChain.SelectedUsageFlags = selected_usage;
+    Vulkan.SwapChain.SelectedImageCount = selected_image_count;
+    Vulkan.SwapChain.AvailablePresentModes = present_modes;
+    Vulkan.SwapChain.MinImageCount = surface_capabilities.minImageCount;
+    Vulkan.SwapChain.MaxImageCount = surface_capabilities.maxImageCount;
+
     uint32_t                        desired_number_of_images = GetSwapChainNumImages( surface_capabilities, selected_image_count );
     vk::SurfaceFormatKHR            desired_format = GetSwapChainFormat( surface_formats );
     vk::Extent2D                    desired_extent = GetSwapChainExtent( surface_capabilities );
@@ -389,6 +540,7 @@ namespace ApiWithoutSecrets {
     if( (desired_extent.width == 0) || (desired_extent.height == 0) ) {
       // Current surface size is (0, 0) so we can't create a swap chain and render anything (CanRender == false)
       // But we don't wont to kill the application as this situation may occur i.e. when window gets minimized
+      RetireSwapChain( old_swap_chain, old_image_views );
       return;
     }
 
@@ -418,6 +570,19 @@ namespace ApiWithoutSecrets {
     Vulkan.SwapChain.PresentMode = desired_present_mode;
     Vulkan.SwapChain.UsageFlags = desired_usage;
     CreateSwapChainImageViews();
+
+    // Old swapchain may still be used by frames in flight
+    RetireSwapChain( old_swap_chain, old_image_views );
+  }
+
+  void VulkanCommon::RetireSwapChain( vk::UniqueSwapchainKHR & swap_chain, std::vector<vk::UniqueImageView> & image_views ) {
+    if( !swap_chain && image_views.empty() ) {
+      return;
+    }
+    // Without any knowledge about frames in flight we need to wait until device stops using old swapchain
+    Vulkan.Device->waitIdle();
+    image_views.clear();
+    swap_chain.reset();
   }
 
   void VulkanCommon::CreateSwapChainImageViews() {
@@ -523,7 +688,8 @@ namespace ApiWithoutSecrets {
         (surface_capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eInputAttachment         ? "    VK_IMAGE_USAGE_INPUT_ATTACHMENT" : "") ).c_str()
       );
     }
-    return vk::ImageUsageFlagBits::eColorAttachment;
+    // Other selected usages are optional and are used only when supported
+    return vk::ImageUsageFlagBits::eColorAttachment | (selected_usage & surface_capabilities.supportedUsageFlags);
   }
 
   vk::SurfaceTransformFlagBitsKHR VulkanCommon::GetSwapChainTransform( vk::SurfaceCapabilitiesKHR const & surface_capabilities ) const {
@@ -119,6 +119,12 @@ namespace ApiWithoutSecrets {
     vk::Extent2D                      Extent;
     vk::PresentModeKHR                PresentMode;
     vk::ImageUsageFlags               UsageFlags;
+    vk::PresentModeKHR                SelectedPresentMode;
+    vk::ImageUsageFlags               SelectedUsageFlags;
+    uint32_t                          SelectedImageCount;
+    std::vector<vk::PresentModeKHR>   AvailablePresentModes;
+    uint32_t                          MinImageCount;
+    uint32_t                          MaxImageCount;
 
     SwapChainParameters() :
       Handle(),
@@ -126,7 +132,13 @@ namespace ApiWithoutSecrets {
       Images(),
       Extent(),
       PresentMode(),
-      UsageFlags() {
+      UsageFlags(),
+      SelectedPresentMode( vk::PresentModeKHR::eMailbox ),
+      SelectedUsageFlags( vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst ),
+      SelectedImageCount( 3 ),
+      AvailablePresentModes(),
+      MinImageCount( 0 ),
+      MaxImageCount( 0 ) {
     }
   };
 
@@ -144,6 +156,10 @@ namespace ApiWithoutSecrets {
     QueueParameters               PresentQueue;
     vk::UniqueSurfaceKHR          PresentationSurface;
     SwapChainParameters           SwapChain;
+    bool                          PresentWaitEnabled;
+    bool                          DescriptorIndexingEnabled;
+    bool                          DescriptorUpdateTemplateEnabled;
+    vk::PhysicalDeviceFeatures    EnabledFeatures;
 
     VulkanCommonParameters() :
       Instance(),
@@ -152,7 +168,11 @@ namespace ApiWithoutSecrets {
       GraphicsQueue(),
       PresentQueue(),
       PresentationSurface(),
-      SwapChain() {
+      SwapChain(),
+      PresentWaitEnabled( false ),
+      DescriptorIndexingEnabled( false ),
+      DescriptorUpdateTemplateEnabled( false ),
+      EnabledFeatures() {
     }
   };
 
@@ -177,11 +197,16 @@ namespace ApiWithoutSecrets {
     QueueParameters const       & GetPresentQueue() const;
 
     vk::SurfaceKHR const        & GetPresentationSurface() const;
+    bool                          IsPresentWaitEnabled() const;
+    bool                          IsDescriptorIndexingEnabled() const;
+    bool                          IsDescriptorUpdateTemplateEnabled() const;
+    bool                          IsTextureCompressionEnabled( vk::Format format ) const;
 
     SwapChainParameters const   & GetSwapChain() const;
 
   protected:
-    void                          CreateSwapChain( vk::PresentModeKHR const selected_present_mode = vk::PresentModeKHR::eMailbox, vk::ImageUsageFlags const selected_usage = vk::ImageUsageFlagBits::eColorAttachment, uint32_t const selected_image_count = 3 );
+    void                          CreateSwapChain( vk::PresentModeKHR const selected_present_mode = vk::PresentModeKHR::eMailbox, vk::ImageUsageFlags const selected_usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst, uint32_t const selected_image_count = 3 );
+    void                          ChangeSwapChainPresentation( vk::PresentModeKHR const selected_present_mode, uint32_t const selected_image_count );
 
   private:
     OS::WindowParameters    Window;
@@ -200,6 +225,7 @@ namespace ApiWithoutSecrets {
     void                            CreateSwapChainImageViews();
     virtual void                    OnWindowSizeChanged_Pre() = 0;
     virtual void                    OnWindowSizeChanged_Post() = 0;
+    virtual void                    RetireSwapChain( vk::UniqueSwapchainKHR & swap_chain, std::vector<vk::UniqueImageView> & image_views );
 
     bool                            CheckExtensionAvailability( const char * extension_name, const std::vector<vk::ExtensionProperties> &available_extensions ) const;
     uint32_t                        GetSwapChainNumImages( vk::SurfaceCapabilitiesKHR const & surface_capabilities, uint32_t selected_image_count ) const;
@@ -0,0 +1,117 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright 2018 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License.  You may obtain a copy
+// of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  See the
+// License for the specific language governing permissions and limitations
+// under the License.
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(VULKAN_EXTENSIONS_HEADER)
+#define VULKAN_EXTENSIONS_HEADER
+
+#include "vulkan.hpp"
+
+// ************************************************************ //
+// Definitions of extensions which are newer than the Vulkan    //
+// headers shipped with the project; they are only provided     //
+// when the headers don't already define them                   //
+// ************************************************************ //
+
+#if !defined(VK_KHR_present_id)
+#define VK_KHR_present_id 1
+#define VK_KHR_PRESENT_ID_SPEC_VERSION    1
+#define VK_KHR_PRESENT_ID_EXTENSION_NAME  "VK_KHR_present_id"
+
+#define VK_STRUCTURE_TYPE_PRESENT_ID_KHR                            static_cast<VkStructureType>(1000294000)
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR   static_cast<VkStructureType>(1000294001)
+
+typedef struct VkPresentIdKHR {
+  VkStructureType     sType;
+  const void*         pNext;
+  uint32_t            swapchainCount;
+  const uint64_t*     pPresentIds;
+} VkPresentIdKHR;
+
+typedef struct VkPhysicalDevicePresentIdFeaturesKHR {
+  VkStructureType     sType;
+  void*               pNext;
+  VkBool32            presentId;
+} VkPhysicalDevicePresentIdFeaturesKHR;
+#endif
+
+#if !defined(VK_KHR_present_wait)
+#define VK_KHR_present_wait 1
+#define VK_KHR_PRESENT_WAIT_SPEC_VERSION    1
+#define VK_KHR_PRESENT_WAIT_EXTENSION_NAME  "VK_KHR_present_wait"
+
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR static_cast<VkStructureType>(1000248000)
+
+typedef struct VkPhysicalDevicePresentWaitFeaturesKHR {
+  VkStructureType     sType;
+  void*               pNext;
+  VkBool32            presentWait;
+} VkPhysicalDevicePresentWaitFeaturesKHR;
+
+typedef VkResult (VKAPI_PTR *PFN_vkWaitForPresentKHR)(VkDevice device, VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout);
+#endif
+
+#if !defined(VK_EXT_descriptor_indexing)
+#define VK_EXT_descriptor_indexing 1
+#define VK_EXT_DESCRIPTOR_INDEXING_SPEC_VERSION   2
+#define VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME "VK_EXT_descriptor_indexing"
+
+#define VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT   static_cast<VkStructureType>(1000161000)
+#define VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT      static_cast<VkStructureType>(1000161001)
+
+#define VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT          0x00000002
+#define VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT                     0x00000002
+
+#define VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT                         0x00000001
+#define VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT               0x00000002
+#define VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT                           0x00000004
+#define VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT_EXT                 0x00000008
+
+typedef VkFlags VkDescriptorBindingFlagsEXT;
+
+typedef struct VkDescriptorSetLayoutBindingFlagsCreateInfoEXT {
+  VkStructureType                     sType;
+  const void*                         pNext;
+  uint32_t                            bindingCount;
+  const VkDescriptorBindingFlagsEXT*  pBindingFlags;
+} VkDescriptorSetLayoutBindingFlagsCreateInfoEXT;
+
+typedef struct VkPhysicalDeviceDescriptorIndexingFeaturesEXT {
+  VkStructureType     sType;
+  void*               pNext;
+  VkBool32            shaderInputAttachmentArrayDynamicIndexing;
+  VkBool32            shaderUniformTexelBufferArrayDynamicIndexing;
+  VkBool32            shaderStorageTexelBufferArrayDynamicIndexing;
+  VkBool32            shaderUniformBufferArrayNonUniformIndexing;
+  VkBool32            shaderSampledImageArrayNonUniformIndexing;
+  VkBool32            shaderStorageBufferArrayNonUniformIndexing;
+  VkBool32            shaderStorageImageArrayNonUniformIndexing;
+  VkBool32            shaderInputAttachmentArrayNonUniformIndexing;
+  VkBool32            shaderUniformTexelBufferArrayNonUniformIndexing;
+  VkBool32            shaderStorageTexelBufferArrayNonUniformIndexing;
+  VkBool32            descriptorBindingUniformBufferUpdateAfterBind;
+  VkBool32            descriptorBindingSampledImageUpdateAfterBind;
+  VkBool32            descriptorBindingStorageImageUpdateAfterBind;
+  VkBool32            descriptorBindingStorageBufferUpdateAfterBind;
+  VkBool32            descriptorBindingUniformTexelBufferUpdateAfterBind;
+  VkBool32            descriptorBindingStorageTexelBufferUpdateAfterBind;
+  VkBool32            descriptorBindingUpdateUnusedWhilePending;
+  VkBool32            descriptorBindingPartiallyBound;
+  VkBool32            descriptorBindingVariableDescriptorCount;
+  VkBool32            runtimeDescriptorArray;
+} VkPhysicalDeviceDescriptorIndexingFeaturesEXT;
+#endif
+
+#endif // VULKAN_EXTENSIONS_HEADER
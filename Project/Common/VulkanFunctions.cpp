@@ -15,6 +15,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "vulkan.hpp"
+#include "VulkanExtensions.h"
 
 namespace ApiWithoutSecrets {
 
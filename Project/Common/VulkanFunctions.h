@@ -18,6 +18,7 @@
 #define VULKAN_FUNCTIONS_HEADER
 
 #include "vulkan.hpp"
+#include "VulkanExtensions.h"
 
 namespace ApiWithoutSecrets {
 
@@ -16,11 +16,15 @@ layout(set=0, binding=1) uniform sampler2D u_BenchmarkTexture;
 
 layout(location = 0) in vec2 v_Texcoord;
 layout(location = 1) in float v_Distance;
+layout(location = 2) in vec4 v_Color;
+layout(location = 3) flat in uint v_TextureIndex;
 
 layout(location = 0) out vec4 o_Color;
 
 void main() {
   vec4 backgroud_image = texture( u_BackgroundTexture, v_Texcoord );
   vec4 benchmark_image = texture( u_BenchmarkTexture, v_Texcoord );
-  o_Color = v_Distance * mix( backgroud_image, benchmark_image, benchmark_image.a );
+  // Both textures are always sampled, index only selects which one is drawn on top
+  vec4 image = (v_TextureIndex == 0) ? mix( backgroud_image, benchmark_image, benchmark_image.a ) : mix( benchmark_image, backgroud_image, backgroud_image.a );
+  o_Color = v_Distance * v_Color * image;
 }
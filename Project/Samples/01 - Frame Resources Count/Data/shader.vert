@@ -12,7 +12,18 @@
 
 layout(location = 0) in vec4 i_Position;
 layout(location = 1) in vec2 i_Texcoord;
-layout(location = 2) in vec4 i_PerInstanceData;
+
+struct InstanceData {
+  vec4  Transform;                              // xy - offset, z - distance, w - scale
+  uint  Color;                                  // RGBA8
+  uint  TextureIndex;
+  uint  LodLevel;                               // Tessellation is halved for each level
+  uint  Padding;
+};
+
+layout(set=1, binding=0) readonly buffer Instances {
+  InstanceData Data[];
+} u_Instances;
 
 layout( push_constant ) uniform Scaling {
   float AspectScale;
@@ -25,13 +36,19 @@ out gl_PerVertex
 
 layout(location = 0) out vec2 v_Texcoord;
 layout(location = 1) out float v_Distance;
+layout(location = 2) out vec4 v_Color;
+layout(location = 3) flat out uint v_TextureIndex;
 
 void main() {
+    InstanceData instance = u_Instances.Data[gl_InstanceIndex];
+
     v_Texcoord = i_Texcoord;
-    v_Distance = 1.0 - i_PerInstanceData.z;       // Darken with distance
+    v_Distance = 1.0 - instance.Transform.z;      // Darken with distance
+    v_Color = unpackUnorm4x8( instance.Color );
+    v_TextureIndex = instance.TextureIndex;
 
     vec4 position = i_Position;
     position.y *= PushConstant.AspectScale;       // Adjust to screen aspect ration
-    position.xy *= pow( v_Distance, 0.5 );        // Scale with distance
-    gl_Position = position + i_PerInstanceData;
+    position.xy *= instance.Transform.w * pow( v_Distance, 0.5 ); // Scale with distance
+    gl_Position = position + vec4( instance.Transform.xyz, 0.0 );
 }
@@ -0,0 +1,31 @@
+// Copyright 2016 Intel Corporation All Rights Reserved
+// 
+// Intel makes no representations about the suitability of this software for any purpose.
+// THIS SOFTWARE IS PROVIDED ""AS IS."" INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES,
+// EXPRESS OR IMPLIED, AND ALL LIABILITY, INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES,
+// FOR THE USE OF THIS SOFTWARE, INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY
+// RIGHTS, AND INCLUDING THE WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// Intel does not assume any responsibility for any errors which may appear in this software
+// nor any responsibility to update it.
+
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// All registered textures, only entries which were written may be accessed
+layout(set=0, binding=0) uniform sampler2D u_Textures[];
+
+layout(location = 0) in vec2 v_Texcoord;
+layout(location = 1) in float v_Distance;
+layout(location = 2) in vec4 v_Color;
+layout(location = 3) flat in uint v_TextureIndex;
+
+layout(location = 0) out vec4 o_Color;
+
+void main() {
+  // Index differs between instances drawn by the same draw call, so it must be marked as non-uniform;
+  // textures are registered in pairs and instance's texture is drawn on top of the other one from its pair
+  vec4 top_image = texture( u_Textures[nonuniformEXT( v_TextureIndex )], v_Texcoord );
+  vec4 bottom_image = texture( u_Textures[nonuniformEXT( v_TextureIndex ^ 1u )], v_Texcoord );
+  vec4 image = mix( bottom_image, top_image, top_image.a );
+  o_Color = v_Distance * v_Color * image;
+}
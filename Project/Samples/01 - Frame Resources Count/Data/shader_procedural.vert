@@ -0,0 +1,66 @@
+// Copyright 2016 Intel Corporation All Rights Reserved
+// 
+// Intel makes no representations about the suitability of this software for any purpose.
+// THIS SOFTWARE IS PROVIDED ""AS IS."" INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES,
+// EXPRESS OR IMPLIED, AND ALL LIABILITY, INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES,
+// FOR THE USE OF THIS SOFTWARE, INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY
+// RIGHTS, AND INCLUDING THE WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// Intel does not assume any responsibility for any errors which may appear in this software
+// nor any responsibility to update it.
+
+#version 450
+
+// Quad grid is generated from a vertex index, so no vertex buffer is bound;
+// vertices of each grid cell are ordered the same way as in the vertex buffer
+
+struct InstanceData {
+  vec4  Transform;                              // xy - offset, z - distance, w - scale
+  uint  Color;                                  // RGBA8
+  uint  TextureIndex;
+  uint  LodLevel;                               // Tessellation is halved for each level
+  uint  Padding;
+};
+
+layout(set=1, binding=0) readonly buffer Instances {
+  InstanceData Data[];
+} u_Instances;
+
+layout( push_constant ) uniform Scaling {
+  float AspectScale;
+  float QuadSize;
+  int   Tessellation;
+} PushConstant;
+
+out gl_PerVertex
+{
+    vec4 gl_Position;
+};
+
+layout(location = 0) out vec2 v_Texcoord;
+layout(location = 1) out float v_Distance;
+layout(location = 2) out vec4 v_Color;
+layout(location = 3) flat out uint v_TextureIndex;
+
+// Two triangles of a single grid cell
+const ivec2 CellCorners[6] = ivec2[6](
+  ivec2( 0, 0 ), ivec2( 0, 1 ), ivec2( 1, 0 ),
+  ivec2( 1, 0 ), ivec2( 0, 1 ), ivec2( 1, 1 )
+);
+
+void main() {
+    InstanceData instance = u_Instances.Data[gl_InstanceIndex];
+
+    int tessellation = max( PushConstant.Tessellation >> instance.LodLevel, 1 );
+    int cell = gl_VertexIndex / 6;
+    ivec2 corner = ivec2( cell / tessellation, cell % tessellation ) + CellCorners[gl_VertexIndex % 6];
+
+    v_Texcoord = vec2( corner ) / float( tessellation );
+    v_Distance = 1.0 - instance.Transform.z;      // Darken with distance
+    v_Color = unpackUnorm4x8( instance.Color );
+    v_TextureIndex = instance.TextureIndex;
+
+    vec4 position = vec4( (2.0 * v_Texcoord - 1.0) * PushConstant.QuadSize, 0.0, 1.0 );
+    position.y *= PushConstant.AspectScale;       // Adjust to screen aspect ration
+    position.xy *= instance.Transform.w * pow( v_Distance, 0.5 ); // Scale with distance
+    gl_Position = position + vec4( instance.Transform.xyz, 0.0 );
+}
@@ -16,12 +16,18 @@
 
 #include <chrono>
 #include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include "Sample.h"
 #include "VulkanFunctions.h"
 #include "imgui/imgui.h"
 
 namespace ApiWithoutSecrets {
 
+  const float SampleParameters::MinResolutionScale = 0.5f;
+  const float SampleParameters::WorldExtent = 4.0f;
+  const float SampleParameters::QuadSize = 0.12f;
+
   Sample::Sample( std::string const & title ) :
     SampleCommon( title ) {
   }
@@ -31,11 +37,14 @@ namespace ApiWithoutSecrets {
 
     CreateFrameResources();
     CreateRenderPasses();
+    CreateSceneTargets();
     CreateDescriptorSet();
     CreateTextures();
     CreatePipelineLayout();
     CreateGraphicsPipeline();
     CreateVertexBuffers();
+    CreateOcclusionCullingPipelines();
+    CreateDescriptorUpdateTemplates();
   }
 
   void Sample::PrepareGUIFrame() {
@@ -45,16 +54,271 @@ namespace ApiWithoutSecrets {
 
     ImGui::SliderIntWithStep( "Scene complexity", &Parameters.ObjectsCount, 10, Parameters.MaxObjectsCount, 50 );
 
-    ImGui::SliderInt( "Frame resources count", &Parameters.FrameResourcesCount, 1, static_cast<int>(FrameResources.size()) );
+    // Large world spreads instances over an area larger than the screen and pans the camera over it
+    if( ImGui::Checkbox( "Large world", &Parameters.LargeWorld ) ) {
+      PlaceInstances();
+    }
+
+    // Only the visible instances are copied to the instance buffer
+    ImGui::Checkbox( "CPU frustum culling", &Parameters.CpuCulling );
+    ImGui::SliderFloat( "Draw distance", &Parameters.DrawDistance, 0.05f, 1.0f, "%.2f" );
+    ImGui::Text( "Drawn instances: %u / %d (%5.3f ms)", Parameters.DrawnObjectsCount, Parameters.ObjectsCount, Parameters.CullingTime );
+
+    // Distant instances are drawn with coarser meshes, visible instances are bucketed per level on the CPU
+    ImGui::Checkbox( "Level of detail", &Parameters.LevelOfDetail );
+    if( Parameters.LevelOfDetail ) {
+      ImGui::SliderFloat( "LOD distance", &Parameters.LodDistance, 0.1f, 4.0f, "%.2f" );
+      if( Parameters.OcclusionCulling ) {
+        ImGui::Text( "Instances surviving occlusion culling use the full detail mesh" );
+      }
+    }
+    ImGui::Text( "Triangles: %llu (%llu at full detail)", static_cast<unsigned long long>(Parameters.DrawnTrianglesCount), static_cast<unsigned long long>(Parameters.FullDetailTrianglesCount) );
+
+    // Scene is split into batches using different pipelines and descriptor sets, sorting them reduces the number of state changes
+    ImGui::SliderInt( "Draw batches", &Parameters.DrawBatchesCount, 1, Parameters.MaxDrawBatchesCount );
+    ImGui::Checkbox( "Sort draw packets", &Parameters.SortDrawPackets );
+    auto const & queue_statistics = Parameters.SceneQueueStatistics;
+    ImGui::Text( "Draws: %u, state changes: %u (%5.3f ms sort)", queue_statistics.DrawsCount, queue_statistics.GetStateChangesCount(), Parameters.SceneQueue.GetSortTime() );
+    ImGui::Text( "  Pipelines: %u, descriptor sets: %u, vertex buffers: %u, index buffers: %u", queue_statistics.PipelineBinds, queue_statistics.DescriptorSetBinds, queue_statistics.VertexBufferBinds, queue_statistics.IndexBufferBinds );
+    ImGui::Text( "  Skipped redundant binds: %u", queue_statistics.SkippedBinds );
+
+    // Quad grid may be generated in the vertex shader from a vertex index, so its tessellation can change without rebuilding a vertex buffer
+    auto & benchmark = Parameters.VertexPathBenchmark;
+    if( benchmark.Running ) {
+      ImGui::Text( "Measuring %s path...", benchmark.Phase == 0 ? "vertex buffer" : "procedural vertices" );
+    } else {
+      ImGui::Checkbox( "Procedural vertices", &Parameters.ProceduralVertices );
+      if( Parameters.ProceduralVertices ) {
+        ImGui::SliderInt( "Quad tessellation", &Parameters.ProceduralTessellation, 1, Parameters.MaxProceduralTessellation );
+      }
+      if( Parameters.TimestampsSupported && ImGui::Button( "Compare vertex paths" ) ) {
+        StartVertexPathBenchmark();
+      }
+    }
+    if( benchmark.ResultsAvailable ) {
+      ImGui::Text( "GPU time - vertex buffer: %5.3f ms, procedural: %5.3f ms", benchmark.Results[0], benchmark.Results[1] );
+    }
+
+    // Instances hidden behind the previous frame's depth are rejected on the GPU before they are drawn
+    if( Parameters.OcclusionCullingSupported ) {
+      if( ImGui::Checkbox( "GPU occlusion culling", &Parameters.OcclusionCulling ) ) {
+        Parameters.DepthPyramid.Valid = false;
+        Parameters.OccludedObjectsCount = 0;
+      }
+      if( Parameters.OcclusionCulling ) {
+        ImGui::Text( "Occluded instances: %u", Parameters.OccludedObjectsCount );
+      }
+    }
+
+    if( ImGui::Checkbox( "Adaptive frame resources count", &Parameters.AdaptiveFrameResourcesCount ) ) {
+      Parameters.FrameResourcesController = FrameResourcesControllerData();
+    }
+
+    // Adaptive mode overwrites the count every frame, so it can be set manually only when the mode is off
+    if( Parameters.AdaptiveFrameResourcesCount ) {
+      ImGui::Text( "Frame resources count: %d", Parameters.FrameResourcesCount );
+    } else {
+      ImGui::SliderInt( "Frame resources count", &Parameters.FrameResourcesCount, 1, static_cast<int>(FrameResources.size()) );
+    }
 
     ImGui::SliderInt( "Pre-submit CPU work time [ms]", &Parameters.PreSubmitCpuWorkTime, 0, 20 );
 
     ImGui::SliderInt( "Post-submit CPU work time [ms]", &Parameters.PostSubmitCpuWorkTime, 0, 20 );
 
+    // CPU work is split into tasks executed by a job system, time set above is a total time of all tasks
+    ImGui::SliderInt( "CPU work tasks", &Parameters.CpuWorkTasksCount, 1, 32 );
+    ImGui::Text( "Job system threads: %u", GetJobThreadCount() );
+
+    // Simulation thread prepares a next frame while the render thread records and submits the current one
+    if( ImGui::Checkbox( "Separate simulation thread", &Parameters.SeparateSimulationThread ) ) {
+      if( Parameters.SeparateSimulationThread ) {
+        StartSimulationThread();
+      } else {
+        StopSimulationThread();
+      }
+      ResetFrameTimePercentiles();
+    }
+    if( Parameters.SeparateSimulationThread ) {
+      ImGui::Text( "Simulation time: %5.2f ms (single task)", Parameters.Simulation.SimulationTime );
+      ImGui::Text( "Render thread wait for simulation: %5.2f ms", Parameters.Simulation.WaitTime );
+      ImGui::Text( "Simulation start to submit latency: %5.2f ms", Parameters.Simulation.Latency );
+    }
+
+    // Memory-bound kernels compete with the driver and the GPU for memory bandwidth
+    {
+      char const * workload_names[static_cast<int>(CpuWorkload::Count)];
+      for( int i = 0; i < static_cast<int>(CpuWorkload::Count); ++i ) {
+        workload_names[i] = GetCpuWorkloadName( static_cast<CpuWorkload>(i) );
+      }
+      ImGui::Combo( "CPU workload", &Parameters.SelectedCpuWorkload, workload_names, static_cast<int>(CpuWorkload::Count) );
+    }
+
+    // Trace replaces constant CPU work times with varying per-frame costs, the same sequence is replayed in each run
+    if( ImGui::Checkbox( "Replay CPU workload trace", &Parameters.ReplayCpuWorkloadTrace ) ) {
+      Parameters.CpuTraceFrameIndex = 0;
+      Parameters.FrameTimePercentiles.clear();
+      ResetFrameTimePercentiles();
+    }
+    if( Parameters.ReplayCpuWorkloadTrace ) {
+      char const * distribution_names[static_cast<int>(CpuWorkloadDistribution::Count)];
+      for( int i = 0; i < static_cast<int>(CpuWorkloadDistribution::Count); ++i ) {
+        distribution_names[i] = GetCpuWorkloadDistributionName( static_cast<CpuWorkloadDistribution>(i) );
+      }
+      ImGui::Combo( "Distribution", &Parameters.SelectedCpuWorkloadDistribution, distribution_names, static_cast<int>(CpuWorkloadDistribution::Count) );
+      ImGui::SliderFloat( "Relative deviation", &Parameters.CpuWorkloadDeviation, 0.0f, 1.0f, "%.2f" );
+
+      bool trace_changed = false;
+      if( ImGui::Button( "Generate trace" ) ) {
+        // Constant work times set above are used as means of both phases
+        Parameters.CpuTrace.Generate( static_cast<CpuWorkloadDistribution>(Parameters.SelectedCpuWorkloadDistribution), static_cast<float>(Parameters.PreSubmitCpuWorkTime), static_cast<float>(Parameters.PostSubmitCpuWorkTime), Parameters.CpuWorkloadDeviation, Parameters.GeneratedTraceFramesCount, 1 );
+        trace_changed = true;
+      }
+      ImGui::SameLine();
+      if( ImGui::Button( "Load trace file" ) ) {
+        if( !Parameters.CpuTrace.LoadFromFile( "Data/" PROJECT_NUMBER_STRING "/CpuTrace.txt" ) ) {
+          Parameters.CpuTrace.Clear();
+        }
+        trace_changed = true;
+      }
+      if( trace_changed ) {
+        Parameters.CpuTraceFrameIndex = 0;
+        Parameters.FrameTimePercentiles.clear();
+        ResetFrameTimePercentiles();
+      }
+      if( Parameters.CpuTrace.IsEmpty() ) {
+        ImGui::Text( "No trace - constant work times are used" );
+      } else {
+        ImGui::Text( "Trace frames: %u", static_cast<uint32_t>(Parameters.CpuTrace.GetSize()) );
+      }
+    }
+
+    if( ImGui::Checkbox( "Mipmapped textures", &Parameters.UseMipmaps ) ) {
+      // Descriptor set is used by all frames in flight
+      GetDevice().waitIdle();
+      UpdateTextureDescriptors();
+    }
+
+    // Textures are selected in the fragment shader from an array of all registered textures with a per-instance index
+    if( Parameters.BindlessSupported ) {
+      ImGui::Checkbox( "Bindless textures", &Parameters.BindlessTextures );
+      if( Parameters.BindlessTextures ) {
+        ImGui::Text( "Registered textures: %u / %u", static_cast<uint32_t>(Parameters.BindlessTextureTable.size()), Parameters.MaxBindlessTexturesCount );
+      }
+    }
+
+    // Descriptor sets of a frame are written again each frame, as if they referenced a different buffer every time
+    ImGui::Checkbox( "Rewrite frame descriptor sets", &Parameters.RewriteFrameDescriptorSets );
+    if( Parameters.RewriteFrameDescriptorSets ) {
+      char const * method_names[SampleParameters::DescriptorUpdateMethodsCount] = {
+        "Individual writes",
+        "Batched writes",
+        "Update templates"
+      };
+      int methods_count = IsDescriptorUpdateTemplateEnabled() ? SampleParameters::DescriptorUpdateMethodsCount : SampleParameters::DescriptorUpdateMethodsCount - 1;
+      ImGui::Combo( "Descriptor updates", &Parameters.DescriptorUpdateMethod, method_names, methods_count );
+      for( int i = 0; i < methods_count; ++i ) {
+        ImGui::BulletText( "%-18s %6.3f us per set", method_names[i], Parameters.DescriptorUpdateTimes[i] );
+      }
+    }
+
     ImGui::Text( "Frame generation time: %5.2f ms", Parameters.FrameGenerationTime );
 
     ImGui::Text( "Total frame time: %5.2f ms", Parameters.TotalFrameTime );
 
+    // Percentiles are remembered for each number of frame resources after a full window of samples is collected
+    ImGui::Text( "Frame time percentiles:" );
+    for( auto & percentiles : Parameters.FrameTimePercentiles ) {
+      ImGui::BulletText( "%d frame resources: p50 %5.2f ms  p90 %5.2f ms  p99 %5.2f ms", percentiles.first, percentiles.second[0], percentiles.second[1], percentiles.second[2] );
+    }
+
+    if( Parameters.TimestampsSupported ) {
+      ImGui::Text( "GPU frame time: %5.2f ms", Parameters.GpuTime );
+    }
+
+    // Scene is rendered into a smaller area of an offscreen image and upscaled so GPU frame time stays within a budget
+    if( Parameters.DynamicResolutionSupported ) {
+      if( ImGui::Checkbox( "Dynamic resolution", &Parameters.DynamicResolution ) ) {
+        Parameters.ResolutionScale = 1.0f;
+      }
+      if( Parameters.DynamicResolution ) {
+        ImGui::SliderFloat( "GPU time budget [ms]", &Parameters.GpuTimeBudget, 1.0f, 33.0f, "%.1f" );
+        ImGui::Text( "Resolution scale: %3.0f%%", Parameters.ResolutionScale * 100.0f );
+      }
+    }
+
+    ImGui::Text( "Fence wait time: %5.2f ms", GetFenceWaitTime() );
+
+    // Benchmark blocks rendering for a moment, it is executed only on request
+    if( ImGui::Button( "Run SIMD math benchmark" ) ) {
+      Parameters.SimdBenchmark = Math::RunBenchmark( 100000, 20 );
+    }
+    if( Parameters.SimdBenchmark.PointsCount > 0 ) {
+      auto & benchmark = Parameters.SimdBenchmark;
+      ImGui::Text( "%s vs scalar, %u points%s:", Math::GetInstructionSet(), static_cast<uint32_t>(benchmark.PointsCount), benchmark.ResultsMatch ? "" : " (results differ!)" );
+      ImGui::BulletText( "1024 matrix multiplies: %6.3f ms vs %6.3f ms", benchmark.SimdMultiplyTime, benchmark.ScalarMultiplyTime );
+      ImGui::BulletText( "Point transforms:       %6.3f ms vs %6.3f ms", benchmark.SimdTransformTime, benchmark.ScalarTransformTime );
+      ImGui::BulletText( "Sphere culling:         %6.3f ms vs %6.3f ms", benchmark.SimdCullingTime, benchmark.ScalarCullingTime );
+      if( benchmark.ResultsMatch && (benchmark.BoundaryMismatchesCount > 0) ) {
+        ImGui::Text( "%u spheres on frustum boundaries culled differently", static_cast<uint32_t>(benchmark.BoundaryMismatchesCount) );
+      }
+    }
+
+    // Presentation parameters - swapchain is recreated on the fly without waiting for frames in flight
+    {
+      auto & swap_chain = GetSwapChain();
+      vk::PresentModeKHR present_mode = swap_chain.PresentMode;
+      bool recreate_swap_chain = false;
+
+      ImGui::NewLine();
+      ImGui::Text( "Present mode:" );
+      for( auto available_present_mode : swap_chain.AvailablePresentModes ) {
+        if( (available_present_mode != vk::PresentModeKHR::eFifo) &&
+            (available_present_mode != vk::PresentModeKHR::eFifoRelaxed) &&
+            (available_present_mode != vk::PresentModeKHR::eMailbox) &&
+            (available_present_mode != vk::PresentModeKHR::eImmediate) ) {
+          continue;
+        }
+        ImGui::SameLine();
+        if( ImGui::RadioButton( vk::to_string( available_present_mode ).c_str(), available_present_mode == swap_chain.PresentMode ) &&
+            (available_present_mode != swap_chain.PresentMode) ) {
+          present_mode = available_present_mode;
+          recreate_swap_chain = true;
+        }
+      }
+
+      int max_image_count = (swap_chain.MaxImageCount > 0) ? static_cast<int>(swap_chain.MaxImageCount) : 8;
+      if( ImGui::SliderInt( "Swapchain images", &Parameters.SwapChainImageCount, static_cast<int>(swap_chain.MinImageCount), max_image_count ) ) {
+        Parameters.SwapChainImageCountEdited = true;
+      }
+      // Swapchain is recreated only once the slider is released, not on each value it passes while being dragged
+      if( Parameters.SwapChainImageCountEdited &&
+          !ImGui::IsItemActive() ) {
+        Parameters.SwapChainImageCountEdited = false;
+        recreate_swap_chain = true;
+      }
+
+      if( recreate_swap_chain ) {
+        ChangeSwapChainPresentation( present_mode, static_cast<uint32_t>(Parameters.SwapChainImageCount) );
+      }
+
+      // Latency is remembered for each combination of a present mode and a number of created swapchain images
+      if( GetFrameLatency() > 0.0f ) {
+        Parameters.MeasuredLatencies[std::make_pair( swap_chain.PresentMode, static_cast<uint32_t>(swap_chain.Images.size()) )] = GetFrameLatency();
+      }
+
+      ImGui::Text( "Frame start to completion latency: %5.2f ms", GetFrameLatency() );
+      for( auto & latency : Parameters.MeasuredLatencies ) {
+        ImGui::BulletText( "%-12s %u images: %6.2f ms", vk::to_string( latency.first.first ).c_str(), latency.first.second, latency.second );
+      }
+    }
+
+    // Latency from sampling the mouse state to presentation of a frame (or its completion when present wait is not available)
+    {
+      auto & input_latency = GetInputLatency();
+      ImGui::Text( "Input to %s latency:", input_latency.IsPresentWaitUsed() ? "present" : "completion" );
+      ImGui::Text( "  p50 %5.2f ms  p90 %5.2f ms  p99 %5.2f ms", input_latency.GetPercentile( 50.0f ), input_latency.GetPercentile( 90.0f ), input_latency.GetPercentile( 99.0f ) );
+    }
+
     ImGui::End();
   }
 
@@ -74,37 +338,424 @@ namespace ApiWithoutSecrets {
     // Star frame - calculate times and prepare GUI
     SampleCommon::StartFrame( current_frame );
 
+    // Fence of current frame resources is signaled so timestamps written during their previous use are available
+    UpdateGpuTime( *SAMPLE_CURRENT_FRAME_RESOURCES_PTR( current_frame ) );
+    UpdateOccludedObjectsCount( *SAMPLE_CURRENT_FRAME_RESOURCES_PTR( current_frame ) );
+    if( Parameters.VertexPathBenchmark.Running ) {
+      UpdateVertexPathBenchmark( Parameters.LastGpuTime );
+    }
+    if( Parameters.DynamicResolution ) {
+      UpdateResolutionScale( Parameters.LastGpuTime );
+    }
+
     // Acquire swapchain image and create a framebuffer
-    SampleCommon::AcquireImage( current_frame, *Parameters.RenderPass );
+    if( !SampleCommon::AcquireImage( current_frame, *Parameters.RenderPass ) ) {
+      return;
+    }
 
     // Draw scene/prepare scene's command buffers
     {
       auto frame_generation_begin_time = std::chrono::high_resolution_clock::now();
 
-      // Perform calculation influencing current frame
-      SampleCommon::PerformHardcoreCalculations( Parameters.PreSubmitCpuWorkTime);
+      if( Parameters.SeparateSimulationThread ) {
+        // Frame was simulated on the simulation thread while the previous one was rendered
+        auto & simulation = Parameters.Simulation;
+        SimulationFrameData simulation_frame;
+        while( !simulation.Results.Pop( simulation_frame ) ) {
+          std::this_thread::yield();
+        }
+        auto wait_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - frame_generation_begin_time);
+        simulation.WaitTime = simulation.WaitTime * 0.99f + static_cast<float>(wait_time.count() * 0.001f) * 0.01f;
+        simulation.SimulationTime = simulation.SimulationTime * 0.99f + simulation_frame.SimulationTime * 0.01f;
+
+        // Draw sample-specific data - includes command buffer submission!!
+        DrawSample( current_frame );
+
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - simulation_frame.StartTime);
+        simulation.Latency = simulation.Latency * 0.99f + static_cast<float>(latency.count() * 0.001f) * 0.01f;
 
-      // Draw sample-specific data - includes command buffer submission!!
-      DrawSample( current_frame );
+        // Slot is reused to request simulation of a next frame
+        RequestSimulation( simulation_frame );
+      } else {
+        float pre_submit_time = 0.0f;
+        float post_submit_time = 0.0f;
+        GetCpuWorkTimes( pre_submit_time, post_submit_time );
 
-      // Perform calculations influencing rendering of a next frame
-      SampleCommon::PerformHardcoreCalculations( Parameters.PostSubmitCpuWorkTime);
+        // Perform calculation influencing current frame
+        SampleCommon::PerformHardcoreCalculations( pre_submit_time, static_cast<uint32_t>(Parameters.CpuWorkTasksCount), static_cast<CpuWorkload>(Parameters.SelectedCpuWorkload) );
+
+        // Draw sample-specific data - includes command buffer submission!!
+        DrawSample( current_frame );
+
+        // Perform calculations influencing rendering of a next frame
+        SampleCommon::PerformHardcoreCalculations( post_submit_time, static_cast<uint32_t>(Parameters.CpuWorkTasksCount), static_cast<CpuWorkload>(Parameters.SelectedCpuWorkload) );
+      }
 
       auto frame_generation_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - frame_generation_begin_time);
       float float_frame_generation_time = static_cast<float>(frame_generation_time.count() * 0.001f);
       Parameters.FrameGenerationTime = Parameters.FrameGenerationTime * 0.99f + float_frame_generation_time * 0.01f;
     }
 
-    // Draw GUI and present swapchain image
-    SampleCommon::FinishFrame( current_frame, *SAMPLE_CURRENT_FRAME_RESOURCES_PTR( current_frame )->PostCommandBuffer, *Parameters.PostRenderPass );
+    // Draw GUI and present swapchain image; end timestamp is written after the GUI so GPU time covers the whole frame
+    auto frame_resources = SAMPLE_CURRENT_FRAME_RESOURCES_PTR( current_frame );
+    SampleCommon::FinishFrame( current_frame, *frame_resources->PostCommandBuffer, *Parameters.PostRenderPass, Parameters.TimestampsSupported ? &(*frame_resources->TimestampCommandBuffer) : nullptr );
 
     auto total_frame_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - frame_begin_time);
     float float_frame_time = static_cast<float>(total_frame_time.count() * 0.001f);
     Parameters.TotalFrameTime = Parameters.TotalFrameTime * 0.99f + float_frame_time * 0.01f;
+    UpdateFrameTimePercentiles( float_frame_time );
+
+    if( Parameters.AdaptiveFrameResourcesCount ) {
+      UpdateFrameResourcesCount( float_frame_time, GetFenceWaitTime(), Parameters.LastGpuTime );
+    }
+  }
+
+  void Sample::UpdateGpuTime( SampleFrameResourcesData & frame_resources ) {
+    if( !frame_resources.TimestampsWritten ) {
+      return;
+    }
+    frame_resources.TimestampsWritten = false;
+
+    uint64_t timestamps[2] = {};
+    if( GetDevice().getQueryPoolResults( *frame_resources.TimestampQueryPool, 0, 2, sizeof( timestamps ), timestamps, sizeof( uint64_t ), vk::QueryResultFlagBits::e64 ) != vk::Result::eSuccess ) {
+      return;
+    }
+    uint64_t ticks = (timestamps[1] - timestamps[0]) & Parameters.TimestampMask;
+    Parameters.LastGpuTime = static_cast<float>(ticks * Parameters.TimestampPeriod * 0.000001);
+    Parameters.GpuTime = Parameters.GpuTime * 0.99f + Parameters.LastGpuTime * 0.01f;
+  }
+
+  void Sample::UpdateOccludedObjectsCount( SampleFrameResourcesData & frame_resources ) {
+    if( !frame_resources.OcclusionCullingWritten ) {
+      return;
+    }
+    frame_resources.OcclusionCullingWritten = false;
+
+    if( !frame_resources.IndirectDrawBufferCoherent ) {
+      vk::MappedMemoryRange memory_range(
+        *frame_resources.IndirectDrawBuffer.Buffer.Memory,  // VkDeviceMemory             memory
+        0,                                                  // VkDeviceSize               offset
+        VK_WHOLE_SIZE                                       // VkDeviceSize               size
+      );
+      GetDevice().invalidateMappedMemoryRanges( { memory_range } );
+    }
+    // Indexed and non-indexed commands store an instance count at the same offset
+    vk::DrawIndirectCommand const * draw_command = reinterpret_cast<vk::DrawIndirectCommand const*>(frame_resources.IndirectDrawBuffer.Pointer);
+    Parameters.OccludedObjectsCount = frame_resources.OcclusionCullingInputCount - std::min( draw_command->instanceCount, frame_resources.OcclusionCullingInputCount );
+  }
+
+  void Sample::UpdateFrameResourcesCount( float frame_time, float fence_wait_time, float gpu_time ) {
+    auto & controller = Parameters.FrameResourcesController;
+
+    controller.FrameTimeSum += frame_time;
+    controller.FenceWaitTimeSum += fence_wait_time;
+    controller.GpuTimeSum += gpu_time;
+    if( ++controller.FramesInWindow < FrameResourcesControllerData::WindowSize ) {
+      return;
+    }
+
+    float window_size = static_cast<float>(controller.FramesInWindow);
+    float average_frame_time = controller.FrameTimeSum / window_size;
+    float average_fence_wait_time = controller.FenceWaitTimeSum / window_size;
+    float average_gpu_time = controller.GpuTimeSum / window_size;
+    float average_cpu_time = average_frame_time - average_fence_wait_time;
+    controller.FramesInWindow = 0;
+    controller.FrameTimeSum = 0.0f;
+    controller.FenceWaitTimeSum = 0.0f;
+    controller.GpuTimeSum = 0.0f;
+
+    // Verify the previous change - fewer frames in flight must not reduce throughput and more frames must increase it
+    if( controller.PreviousCount > 0 ) {
+      bool decreased = Parameters.FrameResourcesCount < controller.PreviousCount;
+      bool keep_change = decreased ? (average_frame_time <= controller.PreviousFrameTime * 1.05f) : (average_frame_time < controller.PreviousFrameTime * 0.95f);
+      if( !keep_change ) {
+        Parameters.FrameResourcesCount = controller.PreviousCount;
+        controller.Settled = true;
+        controller.SettledCpuTime = 0.0f;   // <- Workload is recorded in the next window, with the restored count
+      }
+      controller.PreviousCount = 0;
+      return;
+    }
+
+    // Stay with the selected count until the CPU or GPU workload changes
+    if( controller.Settled ) {
+      if( controller.SettledCpuTime == 0.0f ) {
+        controller.SettledCpuTime = average_cpu_time;
+        controller.SettledGpuTime = average_gpu_time;
+        return;
+      }
+      bool cpu_changed = std::abs( average_cpu_time - controller.SettledCpuTime ) > std::max( 0.2f * controller.SettledCpuTime, 0.5f );
+      bool gpu_changed = std::abs( average_gpu_time - controller.SettledGpuTime ) > std::max( 0.2f * controller.SettledGpuTime, 0.5f );
+      if( !cpu_changed &&
+          !gpu_changed ) {
+        return;
+      }
+      controller.Settled = false;
+    }
+
+    int new_count = Parameters.FrameResourcesCount;
+    if( (average_fence_wait_time > 0.05f * average_frame_time) &&
+        (Parameters.FrameResourcesCount > 1) ) {
+      // CPU waits for the GPU so frames are queued - fewer frames in flight should reduce latency without losing throughput
+      new_count = Parameters.FrameResourcesCount - 1;
+    } else if( (!Parameters.TimestampsSupported || (average_gpu_time < 0.9f * average_frame_time)) &&
+               (Parameters.FrameResourcesCount < static_cast<int>(FrameResources.size())) ) {
+      // GPU is idle for a part of a frame - more frames in flight may let the CPU and the GPU work in parallel
+      new_count = Parameters.FrameResourcesCount + 1;
+    }
+
+    if( new_count == Parameters.FrameResourcesCount ) {
+      controller.Settled = true;
+      controller.SettledCpuTime = average_cpu_time;
+      controller.SettledGpuTime = average_gpu_time;
+      return;
+    }
+    controller.PreviousCount = Parameters.FrameResourcesCount;
+    controller.PreviousFrameTime = average_frame_time;
+    Parameters.FrameResourcesCount = new_count;
+  }
+
+  void Sample::UpdateResolutionScale( float gpu_time ) {
+    if( gpu_time <= 0.0f ) {
+      return;
+    }
+    // GPU time grows roughly with the number of rendered pixels, which is a square of the scale;
+    // the measurement comes from a frame rendered a few frames ago so the correction is damped
+    float desired_scale = Parameters.ResolutionScale * std::sqrt( Parameters.GpuTimeBudget / gpu_time );
+    desired_scale = std::max( Parameters.MinResolutionScale, std::min( desired_scale, 1.0f ) );
+    Parameters.ResolutionScale += (desired_scale - Parameters.ResolutionScale) * 0.1f;
+  }
+
+  void Sample::GetCpuWorkTimes( float & pre_submit_time, float & post_submit_time ) {
+    pre_submit_time = static_cast<float>(Parameters.PreSubmitCpuWorkTime);
+    post_submit_time = static_cast<float>(Parameters.PostSubmitCpuWorkTime);
+    if( Parameters.ReplayCpuWorkloadTrace && !Parameters.CpuTrace.IsEmpty() ) {
+      auto & trace_frame = Parameters.CpuTrace.GetFrame( Parameters.CpuTraceFrameIndex++ );
+      pre_submit_time = trace_frame.PreSubmitTime;
+      post_submit_time = trace_frame.PostSubmitTime;
+    }
+  }
+
+  void Sample::RequestSimulation( SimulationFrameData & frame ) {
+    // Settings are read on the render thread, simulation thread gets only their copy
+    float pre_submit_time = 0.0f;
+    float post_submit_time = 0.0f;
+    GetCpuWorkTimes( pre_submit_time, post_submit_time );
+
+    frame.Index = Parameters.Simulation.NextIndex++;
+    frame.WorkTime = pre_submit_time + post_submit_time;
+    frame.Workload = static_cast<CpuWorkload>(Parameters.SelectedCpuWorkload);
+    frame.SimulationTime = 0.0f;
+    // Number of slots is fixed so there is always space for a returned slot
+    Parameters.Simulation.Requests.Push( frame );
+  }
+
+  void Sample::StartSimulationThread() {
+    auto & simulation = Parameters.Simulation;
+    simulation.StopRequested = false;
+    for( size_t i = 0; i < simulation.SlotsCount; ++i ) {
+      SimulationFrameData frame;
+      RequestSimulation( frame );
+    }
+    simulation.Thread = std::thread( &Sample::SimulationLoop, this );
+  }
+
+  void Sample::StopSimulationThread() {
+    auto & simulation = Parameters.Simulation;
+    if( !simulation.Thread.joinable() ) {
+      return;
+    }
+    simulation.StopRequested = true;
+    simulation.Thread.join();
+
+    // Slots still in flight are dropped
+    SimulationFrameData frame;
+    while( simulation.Requests.Pop( frame ) ) {
+    }
+    while( simulation.Results.Pop( frame ) ) {
+    }
+  }
+
+  void Sample::SimulationLoop() {
+    auto & simulation = Parameters.Simulation;
+    SimulationFrameData frame;
+
+    while( !simulation.StopRequested ) {
+      if( !simulation.Requests.Pop( frame ) ) {
+        std::this_thread::yield();
+        continue;
+      }
+      // Whole CPU work of a frame (both pre- and post-submit parts) is performed here
+      frame.StartTime = std::chrono::high_resolution_clock::now();
+      simulation.Workload.Perform( frame.Workload, static_cast<long long>(1000.0f * frame.WorkTime), static_cast<float>(frame.Index % 1000) * 0.01f );
+      auto simulation_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - frame.StartTime);
+      frame.SimulationTime = static_cast<float>(simulation_time.count() * 0.001f);
+
+      simulation.Results.Push( frame );
+    }
+  }
+
+  void Sample::UpdateFrameTimePercentiles( float frame_time ) {
+    // Samples collected with a different number of frame resources are discarded
+    if( Parameters.FrameTimeSamplesResourcesCount != Parameters.FrameResourcesCount ) {
+      ResetFrameTimePercentiles();
+    }
+
+    if( Parameters.FrameTimeSamples.size() < Parameters.FrameTimeSamplesCount ) {
+      Parameters.FrameTimeSamples.push_back( frame_time );
+    } else {
+      Parameters.FrameTimeSamples[Parameters.NextFrameTimeSample] = frame_time;
+    }
+    Parameters.NextFrameTimeSample = (Parameters.NextFrameTimeSample + 1) % Parameters.FrameTimeSamplesCount;
+    if( Parameters.FrameTimeSamples.size() < Parameters.FrameTimeSamplesCount ) {
+      return;
+    }
+
+    std::vector<float> samples = Parameters.FrameTimeSamples;
+    std::array<float, 3> percentiles;
+    std::array<float, 3> const percentile_values = { 50.0f, 90.0f, 99.0f };
+    for( size_t i = 0; i < percentile_values.size(); ++i ) {
+      size_t index = std::min( static_cast<size_t>(percentile_values[i] * 0.01f * samples.size()), samples.size() - 1 );
+      std::nth_element( samples.begin(), samples.begin() + index, samples.end() );
+      percentiles[i] = samples[index];
+    }
+    Parameters.FrameTimePercentiles[Parameters.FrameResourcesCount] = percentiles;
+  }
+
+  void Sample::ResetFrameTimePercentiles() {
+    Parameters.FrameTimeSamples.clear();
+    Parameters.NextFrameTimeSample = 0;
+    Parameters.FrameTimeSamplesResourcesCount = Parameters.FrameResourcesCount;
+  }
+
+  void Sample::PlaceInstances() {
+    // Positions are always calculated from the base ones, so toggling the world size doesn't accumulate errors;
+    // only positions on the screen plane are scaled, so instance sizes and distances stay the same
+    auto & instances = Parameters.Instances;
+    float world_extent = Parameters.LargeWorld ? Parameters.WorldExtent : 1.0f;
+    for( size_t i = 0; i < instances.X.size(); ++i ) {
+      instances.X[i] = instances.BaseX[i] * world_extent;
+      instances.Y[i] = instances.BaseY[i] * world_extent;
+    }
+  }
+
+  uint32_t Sample::PrepareInstances( SampleFrameResourcesData & frame_resources, float aspect_scale, float & camera_offset_x, float & camera_offset_y ) {
+    auto & instances = Parameters.Instances;
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // Quads are stretched vertically by the aspect ratio and shrink with distance (see shader.vert)
+    if( instances.RadiusAspectScale != aspect_scale ) {
+      float base_radius = Parameters.QuadSize * std::sqrt( 1.0f + aspect_scale * aspect_scale );
+      for( size_t i = 0; i < instances.Radius.size(); ++i ) {
+        instances.Radius[i] = base_radius * instances.Scale[i] * std::sqrt( 1.0f - instances.Z[i] );
+      }
+      instances.RadiusAspectScale = aspect_scale;
+    }
+
+    // In a large world camera slowly pans over the scene; instance positions are moved to screen space which spans [-1, 1]
+    float camera_x = 0.0f;
+    float camera_y = 0.0f;
+    if( Parameters.LargeWorld ) {
+      float time = GetTimer().GetTime();
+      camera_x = (Parameters.WorldExtent - 1.0f) * std::sin( 0.1f * time );
+      camera_y = (Parameters.WorldExtent - 1.0f) * std::cos( 0.07f * time );
+    }
+    camera_offset_x = camera_x - Parameters.CameraX;
+    camera_offset_y = camera_y - Parameters.CameraY;
+    Parameters.CameraX = camera_x;
+    Parameters.CameraY = camera_y;
+
+    uint32_t objects_count = static_cast<uint32_t>(Parameters.ObjectsCount);
+    uint32_t visible_count = objects_count;
+    if( Parameters.CpuCulling ) {
+      Math::Mat4 view_projection( {
+        1.0f,      0.0f,      0.0f,                             0.0f,
+        0.0f,      1.0f,      0.0f,                             0.0f,
+        0.0f,      0.0f,      1.0f / Parameters.DrawDistance,   0.0f,
+        -camera_x, -camera_y, 0.0f,                             1.0f
+      } );
+      Math::Frustum frustum = Math::GetFrustum( view_projection );
+      visible_count = static_cast<uint32_t>(Math::CullSpheres( frustum, instances.X.data(), instances.Y.data(), instances.Z.data(), instances.Radius.data(), objects_count, Parameters.VisibleInstances.data() ));
+    }
+
+    // GPU culling compacts instances in an arbitrary order, so all of them are drawn with a single mesh
+    bool level_of_detail = Parameters.LevelOfDetail && !Parameters.OcclusionCulling;
+    if( level_of_detail ) {
+      BucketInstancesByLod( visible_count );
+    } else {
+      Parameters.LodFirstInstance.fill( visible_count );
+      Parameters.LodFirstInstance[0] = 0;
+    }
+
+    // Surviving instances are compacted into this frame's instance buffer
+    InstanceData * instance_data = reinterpret_cast<InstanceData*>(frame_resources.InstanceBuffer.Pointer);
+    uint32_t lod_level = 0;
+    for( uint32_t i = 0; i < visible_count; ++i ) {
+      uint32_t index = Parameters.CpuCulling || level_of_detail ? Parameters.VisibleInstances[i] : i;
+      while( i >= Parameters.LodFirstInstance[lod_level + 1] ) {
+        ++lod_level;
+      }
+      instance_data[i].Transform[0] = instances.X[index] - camera_x;
+      instance_data[i].Transform[1] = instances.Y[index] - camera_y;
+      instance_data[i].Transform[2] = instances.Z[index];
+      instance_data[i].Transform[3] = instances.Scale[index];
+      instance_data[i].Color = instances.Color[index];
+      instance_data[i].TextureIndex = instances.TextureIndex[index];
+      instance_data[i].LodLevel = lod_level;
+    }
+    // Host-coherent memory doesn't need to be flushed
+    if( !frame_resources.InstanceBufferCoherent && (visible_count > 0) ) {
+      vk::MappedMemoryRange memory_range(
+        *frame_resources.InstanceBuffer.Buffer.Memory,  // VkDeviceMemory             memory
+        0,                                              // VkDeviceSize               offset
+        VK_WHOLE_SIZE                                   // VkDeviceSize               size
+      );
+      GetDevice().flushMappedMemoryRanges( { memory_range } );
+    }
+
+    auto culling_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start_time);
+    Parameters.CullingTime = Parameters.CullingTime * 0.99f + static_cast<float>(culling_time.count() * 0.001f) * 0.01f;
+    Parameters.DrawnObjectsCount = visible_count;
+    return visible_count;
+  }
+
+  void Sample::BucketInstancesByLod( uint32_t instances_count ) {
+    auto const & instances = Parameters.Instances;
+    auto & lod_levels = Parameters.InstanceLodLevels;
+    std::array<uint32_t, SampleParameters::LodLevelsCount> lod_counts = {};
+
+    // Counting sort keeps instances of each level in a contiguous range, so each range is drawn with a single mesh
+    for( uint32_t i = 0; i < instances_count; ++i ) {
+      uint32_t index = Parameters.CpuCulling ? Parameters.VisibleInstances[i] : i;
+      int level = static_cast<int>(instances.Z[index] / Parameters.LodDistance * Parameters.LodLevelsCount);
+      lod_levels[i] = static_cast<uint32_t>(std::min( level, Parameters.LodLevelsCount - 1 ));
+      ++lod_counts[lod_levels[i]];
+    }
+
+    auto & first_instance = Parameters.LodFirstInstance;
+    first_instance[0] = 0;
+    for( int level = 0; level < Parameters.LodLevelsCount; ++level ) {
+      first_instance[level + 1] = first_instance[level] + lod_counts[level];
+      lod_counts[level] = first_instance[level];
+    }
+    for( uint32_t i = 0; i < instances_count; ++i ) {
+      uint32_t index = Parameters.CpuCulling ? Parameters.VisibleInstances[i] : i;
+      Parameters.LodSortedInstances[lod_counts[lod_levels[i]]++] = index;
+    }
+    std::swap( Parameters.VisibleInstances, Parameters.LodSortedInstances );
   }
 
   void Sample::DrawSample( CurrentFrameData & current_frame ) {
     auto frame_resources = SAMPLE_CURRENT_FRAME_RESOURCES_PTR( current_frame );
+    auto swapchain_extent = GetSwapChain().Extent;
+    bool dynamic_resolution = Parameters.DynamicResolution;
+
+    // With dynamic resolution scene is drawn into the top-left part of a full-size offscreen image
+    vk::Extent2D render_extent = swapchain_extent;
+    if( dynamic_resolution ) {
+      render_extent.width = std::max( static_cast<uint32_t>(swapchain_extent.width * Parameters.ResolutionScale), 1u );
+      render_extent.height = std::max( static_cast<uint32_t>(swapchain_extent.height * Parameters.ResolutionScale), 1u );
+    }
 
     std::vector<vk::ClearValue> clear_values = {
       vk::ClearColorValue( std::array<float, 4>{ 0.0f, 0.0f, 0.0f, 1.0f } ),  // VkClearColorValue                      color
@@ -112,48 +763,155 @@ namespace ApiWithoutSecrets {
     };
 
     vk::RenderPassBeginInfo render_pass_begin_info(
-      *Parameters.RenderPass,                           // VkRenderPass                             renderPass
-      *current_frame.FrameResources->Framebuffer,       // VkFramebuffer                            framebuffer
+      dynamic_resolution ?                              // VkRenderPass                             renderPass
+        *Parameters.SceneRenderPass : *Parameters.RenderPass,
+      dynamic_resolution ?                              // VkFramebuffer                            framebuffer
+        *frame_resources->SceneFramebuffer : *current_frame.FrameResources->Framebuffer,
       {                                                 // VkRect2D                                 renderArea
         vk::Offset2D(),                                   // VkOffset2D                               offset
-        GetSwapChain().Extent,                            // VkExtent2D                               extent
+        render_extent,                                    // VkExtent2D                               extent
       },
       static_cast<uint32_t>(clear_values.size()),       // uint32_t                                 clearValueCount
       clear_values.data()                               // const VkClearValue                     * pClearValues
     );
 
-    auto swapchain_extent = GetSwapChain().Extent;
-
     vk::Viewport viewport(
       0,                                                // float                                    x
       0,                                                // float                                    y
-      static_cast<float>(swapchain_extent.width),       // float                                    width
-      static_cast<float>(swapchain_extent.height),      // float                                    height
+      static_cast<float>(render_extent.width),          // float                                    width
+      static_cast<float>(render_extent.height),         // float                                    height
       0.0f,                                             // float                                    minDepth
       1.0f                                              // float                                    maxDepth
     );
 
     vk::Rect2D scissor(
       vk::Offset2D(),                                   // VkOffset2D                               offset
-      GetSwapChain().Extent                             // VkExtent2D                               extent
+      render_extent                                     // VkExtent2D                               extent
     );
 
     float scaling_factor = static_cast<float>(swapchain_extent.width) / static_cast<float>(swapchain_extent.height);
+    float camera_offset_x = 0.0f;
+    float camera_offset_y = 0.0f;
+    uint32_t instances_count = PrepareInstances( *frame_resources, scaling_factor, camera_offset_x, camera_offset_y );
+    if( Parameters.RewriteFrameDescriptorSets ) {
+      RewriteFrameDescriptorSets( *frame_resources );
+    }
+    bool occlusion_culling = Parameters.OcclusionCulling && (instances_count > 0);
     vk::CommandBuffer & command_buffer = *SAMPLE_CURRENT_FRAME_RESOURCES_PTR( current_frame )->PreCommandBuffer;
 
     command_buffer.begin( { vk::CommandBufferUsageFlagBits::eOneTimeSubmit } );
+    if( Parameters.TimestampsSupported ) {
+      command_buffer.resetQueryPool( *frame_resources->TimestampQueryPool, 0, 2 );
+      command_buffer.writeTimestamp( vk::PipelineStageFlagBits::eTopOfPipe, *frame_resources->TimestampQueryPool, 0 );
+    }
+    if( occlusion_culling ) {
+      CullOccludedInstances( *frame_resources, command_buffer, instances_count, scaling_factor, camera_offset_x, camera_offset_y );
+    }
     command_buffer.beginRenderPass( render_pass_begin_info, vk::SubpassContents::eInline );
-    command_buffer.bindPipeline( vk::PipelineBindPoint::eGraphics, *Parameters.GraphicsPipeline );
     command_buffer.setViewport( 0, { viewport } );
     command_buffer.setScissor( 0, { scissor } );
-    command_buffer.bindVertexBuffers( 0, { *Parameters.VertexBuffer.Handle, *Parameters.InstanceBuffer.Handle }, { 0, 0 } );
-    command_buffer.bindDescriptorSets( vk::PipelineBindPoint::eGraphics, *Parameters.PipelineLayout, 0, { *Parameters.DescriptorSet.Handle }, {} );
-    command_buffer.pushConstants( *Parameters.PipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof( float ), &scaling_factor );
-    command_buffer.draw( 6 * Parameters.QuadTessellation * Parameters.QuadTessellation, Parameters.ObjectsCount, 0, 0 );
+    // Quad size and tessellation are read only by the shader generating vertices from an index;
+    // bindless layout has the same push constant ranges, so values pushed here are valid for both layouts
+    struct {
+      float   AspectScale;
+      float   QuadSize;
+      int32_t Tessellation;
+    } push_constants = { scaling_factor, Parameters.QuadSize, Parameters.ProceduralTessellation };
+    command_buffer.pushConstants( *Parameters.PipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof( push_constants ), &push_constants );
+    Parameters.SceneQueue.Clear();
+    Parameters.FullDetailTrianglesCount = static_cast<uint64_t>(GetQuadVertexCount( 0 ) / 3) * instances_count;
+    if( occlusion_culling ) {
+      // Number of instances is provided by the culling pass so all of them are drawn with a single indirect draw
+      DrawPacket packet;
+      packet.SortKey = RenderQueue::MakeSortKey( 0, 0, 0, 0.0f );
+      auto const & pipelines = Parameters.BindlessTextures ? Parameters.BindlessPipelines : Parameters.Pipelines;
+      packet.Pipeline = Parameters.ProceduralVertices ? *pipelines.Procedural : *pipelines.Default;
+      packet.PipelineLayout = Parameters.BindlessTextures ? *Parameters.BindlessPipelineLayout : *Parameters.PipelineLayout;
+      packet.DescriptorSet = Parameters.BindlessTextures ? *Parameters.BindlessDescriptorSet.Handle : *Parameters.DescriptorSet.Handle;
+      SetQuadGeometry( packet, 0 );
+      packet.InstanceDescriptorSet = *frame_resources->CulledInstanceDescriptorSet.Handle;
+      packet.IndirectBuffer = *frame_resources->IndirectDrawBuffer.Buffer.Handle;
+      Parameters.SceneQueue.Submit( packet );
+      Parameters.DrawnTrianglesCount = static_cast<uint64_t>(GetQuadVertexCount( 0 ) / 3) * instances_count;
+    } else {
+      SubmitSceneDrawPackets( *frame_resources, instances_count );
+    }
+    if( Parameters.SortDrawPackets ) {
+      Parameters.SceneQueue.Sort();
+    }
+    Parameters.SceneQueueStatistics = Parameters.SceneQueue.Record( command_buffer, 0 );
     command_buffer.endRenderPass();
+    if( Parameters.OcclusionCulling ) {
+      // Depth of this frame is used to cull instances in the next one
+      BuildDepthPyramid( *frame_resources, command_buffer, render_extent );
+    }
+    if( dynamic_resolution ) {
+      // Upscale rendered area into a swapchain image, which is then used by a post render pass (GUI)
+      vk::Image swapchain_image = current_frame.Swapchain->Images[current_frame.SwapchainImageIndex];
+      vk::ImageSubresourceRange image_subresource_range(
+        vk::ImageAspectFlagBits::eColor,                // VkImageAspectFlags                     aspectMask
+        0,                                              // uint32_t                               baseMipLevel
+        1,                                              // uint32_t                               levelCount
+        0,                                              // uint32_t                               baseArrayLayer
+        1                                               // uint32_t                               layerCount
+      );
+
+      // Transfer stage is included in the semaphore wait stages so the layout transition happens after the image is acquired
+      vk::ImageMemoryBarrier pre_blit_image_memory_barrier(
+        vk::AccessFlags( 0 ),                           // VkAccessFlags                          srcAccessMask
+        vk::AccessFlagBits::eTransferWrite,             // VkAccessFlags                          dstAccessMask
+        vk::ImageLayout::eUndefined,                    // VkImageLayout                          oldLayout
+        vk::ImageLayout::eTransferDstOptimal,           // VkImageLayout                          newLayout
+        VK_QUEUE_FAMILY_IGNORED,                        // uint32_t                               srcQueueFamilyIndex
+        VK_QUEUE_FAMILY_IGNORED,                        // uint32_t                               dstQueueFamilyIndex
+        swapchain_image,                                // VkImage                                image
+        image_subresource_range                         // VkImageSubresourceRange                subresourceRange
+      );
+      command_buffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags( 0 ), {}, {}, { pre_blit_image_memory_barrier } );
+
+      vk::ImageBlit image_blit(
+        vk::ImageSubresourceLayers(                     // VkImageSubresourceLayers               srcSubresource
+          vk::ImageAspectFlagBits::eColor,                // VkImageAspectFlags                     aspectMask
+          0,                                              // uint32_t                               mipLevel
+          0,                                              // uint32_t                               baseArrayLayer
+          1                                               // uint32_t                               layerCount
+        ),
+        {{                                              // VkOffset3D                             srcOffsets[2]
+          vk::Offset3D(),
+          vk::Offset3D( render_extent.width, render_extent.height, 1 )
+        }},
+        vk::ImageSubresourceLayers(                     // VkImageSubresourceLayers               dstSubresource
+          vk::ImageAspectFlagBits::eColor,                // VkImageAspectFlags                     aspectMask
+          0,                                              // uint32_t                               mipLevel
+          0,                                              // uint32_t                               baseArrayLayer
+          1                                               // uint32_t                               layerCount
+        ),
+        {{                                              // VkOffset3D                             dstOffsets[2]
+          vk::Offset3D(),
+          vk::Offset3D( swapchain_extent.width, swapchain_extent.height, 1 )
+        }}
+      );
+      command_buffer.blitImage( *frame_resources->SceneImage.Handle, vk::ImageLayout::eTransferSrcOptimal, swapchain_image, vk::ImageLayout::eTransferDstOptimal, { image_blit }, Parameters.UpscaleFilter );
+
+      vk::ImageMemoryBarrier post_blit_image_memory_barrier(
+        vk::AccessFlagBits::eTransferWrite,             // VkAccessFlags                          srcAccessMask
+        vk::AccessFlagBits::eColorAttachmentRead |      // VkAccessFlags                          dstAccessMask
+        vk::AccessFlagBits::eColorAttachmentWrite,
+        vk::ImageLayout::eTransferDstOptimal,           // VkImageLayout                          oldLayout
+        vk::ImageLayout::eColorAttachmentOptimal,       // VkImageLayout                          newLayout
+        VK_QUEUE_FAMILY_IGNORED,                        // uint32_t                               srcQueueFamilyIndex
+        VK_QUEUE_FAMILY_IGNORED,                        // uint32_t                               dstQueueFamilyIndex
+        swapchain_image,                                // VkImage                                image
+        image_subresource_range                         // VkImageSubresourceRange                subresourceRange
+      );
+      command_buffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::DependencyFlags( 0 ), {}, {}, { post_blit_image_memory_barrier } );
+    }
     command_buffer.end();
 
     vk::PipelineStageFlags wait_dst_stage_mask = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+    if( dynamic_resolution ) {
+      wait_dst_stage_mask |= vk::PipelineStageFlagBits::eTransfer;
+    }
     vk::SubmitInfo submit_info(
       1,                                                          // uint32_t                       waitSemaphoreCount
       &(*current_frame.FrameResources->ImageAvailableSemaphore),  // const VkSemaphore             *pWaitSemaphores
@@ -162,42 +920,363 @@ namespace ApiWithoutSecrets {
       &command_buffer                                             // const VkCommandBuffer         *pCommandBuffers
     );
     GetGraphicsQueue().Handle.submit( { submit_info }, vk::Fence() );
+
+    if( Parameters.TimestampsSupported ) {
+      // End timestamp is submitted after the GUI pass, together with the frame's fence
+      vk::CommandBuffer & timestamp_command_buffer = *frame_resources->TimestampCommandBuffer;
+      timestamp_command_buffer.begin( { vk::CommandBufferUsageFlagBits::eOneTimeSubmit } );
+      timestamp_command_buffer.writeTimestamp( vk::PipelineStageFlagBits::eBottomOfPipe, *frame_resources->TimestampQueryPool, 1 );
+      timestamp_command_buffer.end();
+      frame_resources->TimestampsWritten = true;
+    }
   }
 
-  void Sample::OnSampleWindowSizeChanged_Pre() {
+  void Sample::SubmitSceneDrawPackets( SampleFrameResourcesData & frame_resources, uint32_t instances_count ) {
+    // Batches alternate between pipelines and descriptor sets like objects with different materials would
+    auto const & scene_pipelines = Parameters.BindlessTextures ? Parameters.BindlessPipelines : Parameters.Pipelines;
+    vk::Pipeline pipelines[2] = { *scene_pipelines.Default, *scene_pipelines.Alternate };
+    if( Parameters.ProceduralVertices ) {
+      pipelines[0] = *scene_pipelines.Procedural;
+      pipelines[1] = *scene_pipelines.ProceduralAlternate;
+    }
+    vk::PipelineLayout pipeline_layout = *Parameters.PipelineLayout;
+    vk::DescriptorSet descriptor_sets[2] = { *Parameters.DescriptorSet.Handle, *Parameters.AlternateDescriptorSet.Handle };
+    if( Parameters.BindlessTextures ) {
+      // All textures are available through a single set, so the whole scene binds it once
+      pipeline_layout = *Parameters.BindlessPipelineLayout;
+      descriptor_sets[0] = *Parameters.BindlessDescriptorSet.Handle;
+      descriptor_sets[1] = *Parameters.BindlessDescriptorSet.Handle;
+    }
+    auto const & instances = Parameters.Instances;
+
+    uint64_t triangles_count = 0;
+    uint32_t batches_count = std::min( static_cast<uint32_t>(Parameters.DrawBatchesCount), instances_count );
+    for( uint32_t batch = 0; batch < batches_count; ++batch ) {
+      uint32_t first_instance = static_cast<uint32_t>(static_cast<uint64_t>(instances_count) * batch / batches_count);
+      uint32_t last_instance = static_cast<uint32_t>(static_cast<uint64_t>(instances_count) * (batch + 1) / batches_count);
+
+      // Instances are sorted by their level of detail, so a batch is split into ranges using different meshes
+      uint32_t lod_level = 0;
+      for( uint32_t range_first = first_instance; range_first < last_instance; ) {
+        while( range_first >= Parameters.LodFirstInstance[lod_level + 1] ) {
+          ++lod_level;
+        }
+        uint32_t range_last = std::min( last_instance, Parameters.LodFirstInstance[lod_level + 1] );
+
+        // Ranges are drawn front-to-back within the same state, ordered by their nearest instance
+        float depth = 1.0f;
+        for( uint32_t i = range_first; i < range_last; ++i ) {
+          uint32_t index = Parameters.CpuCulling || Parameters.LevelOfDetail ? Parameters.VisibleInstances[i] : i;
+          depth = std::min( depth, instances.Z[index] );
+        }
+
+        uint32_t pipeline_index = batch % 2;
+        uint32_t descriptor_set_index = Parameters.BindlessTextures ? 0 : (batch / 2) % 2;
+        DrawPacket packet;
+        packet.SortKey = RenderQueue::MakeSortKey( 0, pipeline_index, descriptor_set_index, depth );
+        packet.Pipeline = pipelines[pipeline_index];
+        packet.PipelineLayout = pipeline_layout;
+        packet.DescriptorSet = descriptor_sets[descriptor_set_index];
+        SetQuadGeometry( packet, lod_level );
+        packet.InstanceDescriptorSet = *frame_resources.InstanceDescriptorSet.Handle;
+        packet.InstanceCount = range_last - range_first;
+        packet.FirstInstance = range_first;
+        Parameters.SceneQueue.Submit( packet );
+
+        triangles_count += static_cast<uint64_t>(GetQuadVertexCount( lod_level ) / 3) * packet.InstanceCount;
+        range_first = range_last;
+      }
+    }
+    Parameters.DrawnTrianglesCount = triangles_count;
   }
 
-  void Sample::OnSampleWindowSizeChanged_Post() {
-    // Create depth attachmnet and transition it away from an undefined layout
-    {
-      vk::ImageSubresourceRange image_subresource_range(
-        vk::ImageAspectFlagBits::eDepth,                                // VkImageAspectFlags               aspectMask
-        0,                                                              // uint32_t                         baseMipLevel
-        1,                                                              // uint32_t                         levelCount
-        0,                                                              // uint32_t                         baseArrayLayer
-        1                                                               // uint32_t                         layerCount
+  uint32_t Sample::GetQuadVertexCount( uint32_t lod_level ) const {
+    // Geometry arena always contains grids of a default tessellation and its levels of detail; for indexed grids this is a number of indices
+    int tessellation = Parameters.ProceduralVertices ? Parameters.ProceduralTessellation : Parameters.QuadTessellation;
+    tessellation = std::max( tessellation >> lod_level, 1 );
+    return static_cast<uint32_t>(6 * tessellation * tessellation);
+  }
+
+  void Sample::SetQuadGeometry( DrawPacket & packet, uint32_t lod_level ) const {
+    if( Parameters.ProceduralVertices ) {
+      // gl_VertexIndex includes the first vertex, so procedurally generated grids always start from 0
+      packet.VertexCount = GetQuadVertexCount( lod_level );
+      return;
+    }
+    // All levels of detail share the geometry arena, so switching between them doesn't change bound buffers
+    auto const & mesh = Parameters.Geometry.Meshes[Parameters.QuadLodMeshes[lod_level]];
+    packet.VertexBuffer = *Parameters.Geometry.Buffer.Handle;
+    packet.IndexBuffer = *Parameters.Geometry.Buffer.Handle;
+    packet.IndexBufferOffset = Parameters.Geometry.IndexOffset;
+    packet.IndexCount = mesh.IndexCount;
+    packet.FirstIndex = mesh.FirstIndex;
+    packet.VertexOffset = mesh.VertexOffset;
+  }
+
+  void Sample::StartVertexPathBenchmark() {
+    auto & benchmark = Parameters.VertexPathBenchmark;
+    benchmark.Running = true;
+    benchmark.Phase = 0;
+    benchmark.FrameIndex = 0;
+    benchmark.GpuTimeSum = 0.0f;
+    benchmark.ResultsAvailable = false;
+    benchmark.PreviousProceduralVertices = Parameters.ProceduralVertices;
+    benchmark.PreviousTessellation = Parameters.ProceduralTessellation;
+
+    // Both paths draw the same number of vertices
+    Parameters.ProceduralVertices = false;
+    Parameters.ProceduralTessellation = Parameters.QuadTessellation;
+  }
+
+  void Sample::UpdateVertexPathBenchmark( float gpu_time ) {
+    auto & benchmark = Parameters.VertexPathBenchmark;
+
+    // First frames after a switch may still report times of frames drawn with the previous path
+    if( benchmark.FrameIndex >= benchmark.WarmUpFrames ) {
+      benchmark.GpuTimeSum += gpu_time;
+    }
+    if( ++benchmark.FrameIndex < benchmark.WarmUpFrames + benchmark.MeasuredFrames ) {
+      return;
+    }
+    benchmark.Results[benchmark.Phase] = benchmark.GpuTimeSum / benchmark.MeasuredFrames;
+    benchmark.FrameIndex = 0;
+    benchmark.GpuTimeSum = 0.0f;
+
+    if( benchmark.Phase == 0 ) {
+      benchmark.Phase = 1;
+      Parameters.ProceduralVertices = true;
+    } else {
+      benchmark.Running = false;
+      benchmark.ResultsAvailable = true;
+      Parameters.ProceduralVertices = benchmark.PreviousProceduralVertices;
+      Parameters.ProceduralTessellation = benchmark.PreviousTessellation;
+    }
+  }
+
+  void Sample::CullOccludedInstances( SampleFrameResourcesData & frame_resources, vk::CommandBuffer & command_buffer, uint32_t instances_count, float aspect_scale, float camera_offset_x, float camera_offset_y ) {
+    auto & pyramid = Parameters.DepthPyramid;
+
+    // Draw command starts without instances, those which pass the test are appended by the culling shader;
+    // instance count is stored at the same offset in both indexed and non-indexed commands
+    if( Parameters.ProceduralVertices ) {
+      vk::DrawIndirectCommand draw_command(
+        GetQuadVertexCount( 0 ),                                      // uint32_t                       vertexCount
+        0,                                                            // uint32_t                       instanceCount
+        0,                                                            // uint32_t                       firstVertex
+        0                                                             // uint32_t                       firstInstance
       );
-      for( size_t i = 0; i < FrameResources.size(); ++i ) {
-        SAMPLE_FRAME_RESOURCES_PTR( i )->DepthAttachment = SampleCommon::CreateImage( GetSwapChain().Extent.width, GetSwapChain().Extent.height, DefaultDepthFormat, vk::ImageUsageFlagBits::eDepthStencilAttachment, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eDepth );
-        SampleCommon::SetImageMemoryBarrier( *SAMPLE_FRAME_RESOURCES_PTR( i )->DepthAttachment.Handle, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::PipelineStageFlagBits::eEarlyFragmentTests );
-      }
+      command_buffer.updateBuffer( *frame_resources.IndirectDrawBuffer.Buffer.Handle, 0, sizeof( draw_command ), &draw_command );
+    } else {
+      auto const & mesh = Parameters.Geometry.Meshes[Parameters.QuadLodMeshes[0]];
+      vk::DrawIndexedIndirectCommand draw_command(
+        mesh.IndexCount,                                              // uint32_t                       indexCount
+        0,                                                            // uint32_t                       instanceCount
+        mesh.FirstIndex,                                              // uint32_t                       firstIndex
+        mesh.VertexOffset,                                            // int32_t                        vertexOffset
+        0                                                             // uint32_t                       firstInstance
+      );
+      command_buffer.updateBuffer( *frame_resources.IndirectDrawBuffer.Buffer.Handle, 0, sizeof( draw_command ), &draw_command );
     }
-    // Pre-transition all swapchain images away from an undefined layout
-    {
-      vk::ImageSubresourceRange image_subresource_range(
-        vk::ImageAspectFlagBits::eColor,                                // VkImageAspectFlags               aspectMask
-        0,                                                              // uint32_t                         baseMipLevel
-        1,                                                              // uint32_t                         levelCount
-        0,                                                              // uint32_t                         baseArrayLayer
-        1                                                               // uint32_t                         layerCount
+
+    vk::MemoryBarrier pre_culling_memory_barrier(
+      vk::AccessFlagBits::eTransferWrite,                             // VkAccessFlags                  srcAccessMask
+      vk::AccessFlagBits::eShaderRead |                               // VkAccessFlags                  dstAccessMask
+      vk::AccessFlagBits::eShaderWrite
+    );
+    std::vector<vk::ImageMemoryBarrier> pre_culling_image_memory_barriers;
+    if( !pyramid.Valid ) {
+      // Pyramid wasn't built yet so the test is skipped, but the image must be in a layout expected by the descriptor
+      pre_culling_image_memory_barriers.emplace_back(
+        vk::AccessFlags( 0 ),                                         // VkAccessFlags                  srcAccessMask
+        vk::AccessFlagBits::eShaderRead,                              // VkAccessFlags                  dstAccessMask
+        vk::ImageLayout::eUndefined,                                  // VkImageLayout                  oldLayout
+        vk::ImageLayout::eGeneral,                                    // VkImageLayout                  newLayout
+        VK_QUEUE_FAMILY_IGNORED,                                      // uint32_t                       srcQueueFamilyIndex
+        VK_QUEUE_FAMILY_IGNORED,                                      // uint32_t                       dstQueueFamilyIndex
+        *pyramid.Image.Handle,                                        // VkImage                        image
+        vk::ImageSubresourceRange(                                    // VkImageSubresourceRange        subresourceRange
+          vk::ImageAspectFlagBits::eColor,                              // VkImageAspectFlags             aspectMask
+          0,                                                            // uint32_t                       baseMipLevel
+          pyramid.LevelsCount,                                          // uint32_t                       levelCount
+          0,                                                            // uint32_t                       baseArrayLayer
+          1                                                             // uint32_t                       layerCount
+        )
       );
-      for( auto & swapchain_image : GetSwapChain().Images ) {
-        SampleCommon::SetImageMemoryBarrier( swapchain_image, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::ePresentSrcKHR, vk::AccessFlagBits::eMemoryRead, vk::PipelineStageFlagBits::eBottomOfPipe );
+    }
+    command_buffer.pipelineBarrier( vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags( 0 ), { pre_culling_memory_barrier }, {}, pre_culling_image_memory_barriers );
+
+    // Layout must match the push constant block in occlusion_culling.comp
+    struct {
+      float     CameraOffset[2];
+      float     QuadSize;
+      float     AspectScale;
+      uint32_t  InstancesCount;
+      uint32_t  UseDepthPyramid;
+    } push_constants = {
+      { camera_offset_x, camera_offset_y },
+      Parameters.QuadSize,
+      aspect_scale,
+      instances_count,
+      pyramid.Valid ? 1u : 0u
+    };
+
+    command_buffer.bindPipeline( vk::PipelineBindPoint::eCompute, *Parameters.OcclusionCullingPipeline );
+    command_buffer.bindDescriptorSets( vk::PipelineBindPoint::eCompute, *Parameters.OcclusionCullingPipelineLayout, 0, { *frame_resources.OcclusionCullingDescriptorSet.Handle }, {} );
+    command_buffer.pushConstants( *Parameters.OcclusionCullingPipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof( push_constants ), &push_constants );
+    command_buffer.dispatch( (instances_count + 63) / 64, 1, 1 );
+
+    // Culled instances and the draw command are consumed by the draw; instance count is also read on the CPU
+    vk::MemoryBarrier post_culling_memory_barrier(
+      vk::AccessFlagBits::eShaderWrite,                               // VkAccessFlags                  srcAccessMask
+      vk::AccessFlagBits::eIndirectCommandRead |                      // VkAccessFlags                  dstAccessMask
+      vk::AccessFlagBits::eVertexAttributeRead |
+      vk::AccessFlagBits::eHostRead
+    );
+    command_buffer.pipelineBarrier( vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eHost, vk::DependencyFlags( 0 ), { post_culling_memory_barrier }, {}, {} );
+
+    frame_resources.OcclusionCullingWritten = true;
+    frame_resources.OcclusionCullingInputCount = instances_count;
+  }
+
+  void Sample::BuildDepthPyramid( SampleFrameResourcesData & frame_resources, vk::CommandBuffer & command_buffer, vk::Extent2D const & render_extent ) {
+    auto & pyramid = Parameters.DepthPyramid;
+
+    vk::ImageSubresourceRange depth_subresource_range(
+      vk::ImageAspectFlagBits::eDepth,                                // VkImageAspectFlags             aspectMask
+      0,                                                              // uint32_t                       baseMipLevel
+      1,                                                              // uint32_t                       levelCount
+      0,                                                              // uint32_t                       baseArrayLayer
+      1                                                               // uint32_t                       layerCount
+    );
+
+    // Depth attachment is read in shaders; previous contents of the pyramid, read by the culling pass, are discarded
+    std::vector<vk::ImageMemoryBarrier> pre_build_image_memory_barriers = {
+      {
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,             // VkAccessFlags                  srcAccessMask
+        vk::AccessFlagBits::eShaderRead,                              // VkAccessFlags                  dstAccessMask
+        vk::ImageLayout::eDepthStencilAttachmentOptimal,              // VkImageLayout                  oldLayout
+        vk::ImageLayout::eDepthStencilReadOnlyOptimal,                // VkImageLayout                  newLayout
+        VK_QUEUE_FAMILY_IGNORED,                                      // uint32_t                       srcQueueFamilyIndex
+        VK_QUEUE_FAMILY_IGNORED,                                      // uint32_t                       dstQueueFamilyIndex
+        *frame_resources.DepthAttachment.Handle,                      // VkImage                        image
+        depth_subresource_range                                       // VkImageSubresourceRange        subresourceRange
+      },
+      {
+        vk::AccessFlags( 0 ),                                         // VkAccessFlags                  srcAccessMask
+        vk::AccessFlagBits::eShaderWrite,                             // VkAccessFlags                  dstAccessMask
+        vk::ImageLayout::eUndefined,                                  // VkImageLayout                  oldLayout
+        vk::ImageLayout::eGeneral,                                    // VkImageLayout                  newLayout
+        VK_QUEUE_FAMILY_IGNORED,                                      // uint32_t                       srcQueueFamilyIndex
+        VK_QUEUE_FAMILY_IGNORED,                                      // uint32_t                       dstQueueFamilyIndex
+        *pyramid.Image.Handle,                                        // VkImage                        image
+        {                                                             // VkImageSubresourceRange        subresourceRange
+          vk::ImageAspectFlagBits::eColor,                              // VkImageAspectFlags             aspectMask
+          0,                                                            // uint32_t                       baseMipLevel
+          pyramid.LevelsCount,                                          // uint32_t                       levelCount
+          0,                                                            // uint32_t                       baseArrayLayer
+          1                                                             // uint32_t                       layerCount
+        }
       }
+    };
+    command_buffer.pipelineBarrier( vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags( 0 ), {}, {}, pre_build_image_memory_barriers );
+
+    // Each level is built from the previous one, level 0 from the rendered part of the depth attachment
+    vk::MemoryBarrier level_memory_barrier(
+      vk::AccessFlagBits::eShaderWrite,                               // VkAccessFlags                  srcAccessMask
+      vk::AccessFlagBits::eShaderRead                                 // VkAccessFlags                  dstAccessMask
+    );
+    command_buffer.bindPipeline( vk::PipelineBindPoint::eCompute, *Parameters.DepthDownsamplePipeline );
+    uint32_t extents[4] = { render_extent.width, render_extent.height, 0, 0 };
+    for( uint32_t level = 0; level < pyramid.LevelsCount; ++level ) {
+      extents[2] = std::max( pyramid.Width >> level, 1u );
+      extents[3] = std::max( pyramid.Height >> level, 1u );
+      if( level > 0 ) {
+        command_buffer.pipelineBarrier( vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags( 0 ), { level_memory_barrier }, {}, {} );
+      }
+      vk::DescriptorSet descriptor_set = (level == 0) ? *frame_resources.DepthDownsampleDescriptorSet.Handle : *pyramid.LevelDescriptorSets[level].Handle;
+      command_buffer.bindDescriptorSets( vk::PipelineBindPoint::eCompute, *Parameters.DepthDownsamplePipelineLayout, 0, { descriptor_set }, {} );
+      command_buffer.pushConstants( *Parameters.DepthDownsamplePipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof( extents ), extents );
+      command_buffer.dispatch( (extents[2] + 7) / 8, (extents[3] + 7) / 8, 1 );
+      extents[0] = extents[2];
+      extents[1] = extents[3];
+    }
+
+    // Depth attachment is used again by the GUI render pass, pyramid is read by the culling pass of a next frame
+    vk::ImageMemoryBarrier post_build_image_memory_barrier(
+      vk::AccessFlagBits::eShaderRead,                                // VkAccessFlags                  srcAccessMask
+      vk::AccessFlagBits::eDepthStencilAttachmentRead |               // VkAccessFlags                  dstAccessMask
+      vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+      vk::ImageLayout::eDepthStencilReadOnlyOptimal,                  // VkImageLayout                  oldLayout
+      vk::ImageLayout::eDepthStencilAttachmentOptimal,                // VkImageLayout                  newLayout
+      VK_QUEUE_FAMILY_IGNORED,                                        // uint32_t                       srcQueueFamilyIndex
+      VK_QUEUE_FAMILY_IGNORED,                                        // uint32_t                       dstQueueFamilyIndex
+      *frame_resources.DepthAttachment.Handle,                        // VkImage                        image
+      depth_subresource_range                                         // VkImageSubresourceRange        subresourceRange
+    );
+    command_buffer.pipelineBarrier( vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags( 0 ), { level_memory_barrier }, {}, { post_build_image_memory_barrier } );
+
+    pyramid.Valid = true;
+  }
+
+  void Sample::OnSampleWindowSizeChanged_Pre() {
+  }
+
+  void Sample::OnSampleWindowSizeChanged_Post() {
+    // Create depth attachments - they are transitioned away from an undefined layout at the beginning of a render pass
+    // Previous attachments may still be used by frames in flight so they are released later
+    vk::ImageUsageFlags depth_usage = vk::ImageUsageFlagBits::eDepthStencilAttachment;
+    if( Parameters.OcclusionCullingSupported ) {
+      depth_usage |= vk::ImageUsageFlagBits::eSampled;
+    }
+    for( size_t i = 0; i < FrameResources.size(); ++i ) {
+      SampleCommon::DeferDestruction( std::move( SAMPLE_FRAME_RESOURCES_PTR( i )->DepthAttachment ) );
+      SAMPLE_FRAME_RESOURCES_PTR( i )->DepthAttachment = SampleCommon::CreateImage( GetSwapChain().Extent.width, GetSwapChain().Extent.height, DefaultDepthFormat, depth_usage, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eDepth );
+    }
+    // Depth pyramid and descriptor sets referencing depth attachments
+    if( Parameters.OcclusionCullingSupported ) {
+      CreateDepthPyramid();
+    }
+    // Offscreen targets reference depth attachments, during initialization they are created after render passes
+    if( Parameters.SceneRenderPass ) {
+      CreateSceneTargets();
+    }
+  }
+
+  void Sample::CreateSceneTargets() {
+    // Dynamic resolution requires GPU time measurements and a possibility to blit from offscreen images into swapchain images
+    // Offscreen images are created with the swapchain's format, so it must support both ends of the blit
+    vk::Format swap_chain_format = GetSwapChain().Format;
+    Parameters.DynamicResolutionSupported = Parameters.TimestampsSupported &&
+                                            (GetSwapChain().UsageFlags & vk::ImageUsageFlagBits::eTransferDst) &&
+                                            SampleCommon::IsFormatFeatureSupported( swap_chain_format, vk::FormatFeatureFlagBits::eColorAttachment | vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst );
+    if( !Parameters.DynamicResolutionSupported ) {
+      Parameters.DynamicResolution = false;
+      return;
+    }
+    // Linear filtering of a blit requires a support for linear filtering of its source format
+    Parameters.UpscaleFilter = SampleCommon::IsFormatFeatureSupported( swap_chain_format, vk::FormatFeatureFlagBits::eSampledImageFilterLinear ) ? vk::Filter::eLinear : vk::Filter::eNearest;
+
+    // Images have a full swapchain size so changing the scale doesn't require any reallocation
+    for( size_t i = 0; i < FrameResources.size(); ++i ) {
+      auto frame_resources = SAMPLE_FRAME_RESOURCES_PTR( i );
+      SampleCommon::DeferDestruction( std::move( frame_resources->SceneFramebuffer ) );
+      SampleCommon::DeferDestruction( std::move( frame_resources->SceneImage ) );
+      frame_resources->SceneImage = SampleCommon::CreateImage( GetSwapChain().Extent.width, GetSwapChain().Extent.height, swap_chain_format, vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eColor );
+      frame_resources->SceneFramebuffer = SampleCommon::CreateFramebuffer( { *frame_resources->SceneImage.View, *frame_resources->DepthAttachment.View }, GetSwapChain().Extent, *Parameters.SceneRenderPass );
     }
   }
  
   void Sample::CreateFrameResources() {
+    // GPU time is measured with timestamps if graphics queue supports them
+    uint32_t timestamp_valid_bits = GetPhysicalDevice().getQueueFamilyProperties()[GetGraphicsQueue().FamilyIndex].timestampValidBits;
+    Parameters.TimestampsSupported = timestamp_valid_bits > 0;
+    Parameters.TimestampPeriod = GetPhysicalDevice().getProperties().limits.timestampPeriod;
+    Parameters.TimestampMask = (timestamp_valid_bits >= 64) ? ~0ull : ((1ull << timestamp_valid_bits) - 1);
+
+    // Occlusion culling is performed with compute shaders on the graphics queue and reads depth attachments
+    bool compute_supported = static_cast<bool>(GetPhysicalDevice().getQueueFamilyProperties()[GetGraphicsQueue().FamilyIndex].queueFlags & vk::QueueFlagBits::eCompute);
+    Parameters.OcclusionCullingSupported = compute_supported && SampleCommon::IsFormatFeatureSupported( DefaultDepthFormat, vk::FormatFeatureFlagBits::eSampledImage );
+
     for( size_t i = 0; i < FrameResources.size(); ++i ) {
       FrameResources[i] = std::make_unique<SampleFrameResourcesData>();
       auto frame_resources = SAMPLE_FRAME_RESOURCES_PTR( i );
@@ -208,7 +1287,40 @@ namespace ApiWithoutSecrets {
       frame_resources->CommandPool = SampleCommon::CreateCommandPool( GetGraphicsQueue().FamilyIndex, vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient );
       frame_resources->PreCommandBuffer = std::move( SampleCommon::AllocateCommandBuffers( *frame_resources->CommandPool, vk::CommandBufferLevel::ePrimary, 1 )[0] );
       frame_resources->PostCommandBuffer = std::move( SampleCommon::AllocateCommandBuffers( *frame_resources->CommandPool, vk::CommandBufferLevel::ePrimary, 1 )[0] );
-      
+      if( Parameters.TimestampsSupported ) {
+        frame_resources->TimestampCommandBuffer = std::move( SampleCommon::AllocateCommandBuffers( *frame_resources->CommandPool, vk::CommandBufferLevel::ePrimary, 1 )[0] );
+        frame_resources->TimestampQueryPool = SampleCommon::CreateQueryPool( vk::QueryType::eTimestamp, 2 );
+      }
+      // Instance data is written every frame so it is kept in persistently mapped, host-visible memory
+      // Records are read in the vertex shader through gl_InstanceIndex
+      uint32_t instance_buffer_size = Parameters.MaxObjectsCount * sizeof( InstanceData );
+      vk::BufferUsageFlags instance_buffer_usage = vk::BufferUsageFlagBits::eStorageBuffer;
+      try {
+        frame_resources->InstanceBuffer.Buffer = SampleCommon::CreateBuffer( instance_buffer_size, instance_buffer_usage, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent );
+        frame_resources->InstanceBufferCoherent = true;
+      } catch( ... ) {
+        frame_resources->InstanceBuffer.Buffer = SampleCommon::CreateBuffer( instance_buffer_size, instance_buffer_usage, vk::MemoryPropertyFlagBits::eHostVisible );
+        frame_resources->InstanceBufferCoherent = false;
+      }
+      frame_resources->InstanceBuffer.Pointer = GetDevice().mapMemory( *frame_resources->InstanceBuffer.Buffer.Memory, 0, VK_WHOLE_SIZE );
+      frame_resources->InstanceDescriptorSet = CreateInstanceDescriptorSet( *frame_resources->InstanceBuffer.Buffer.Handle );
+
+      if( Parameters.OcclusionCullingSupported ) {
+        // Instances which passed the occlusion test and the draw command are written on the GPU
+        // Draw command is also read on the CPU to count rejected instances
+        frame_resources->CulledInstanceBuffer = SampleCommon::CreateBuffer( instance_buffer_size, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal );
+        frame_resources->CulledInstanceDescriptorSet = CreateInstanceDescriptorSet( *frame_resources->CulledInstanceBuffer.Handle );
+        uint32_t indirect_buffer_size = sizeof( vk::DrawIndexedIndirectCommand );
+        vk::BufferUsageFlags indirect_buffer_usage = vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+        try {
+          frame_resources->IndirectDrawBuffer.Buffer = SampleCommon::CreateBuffer( indirect_buffer_size, indirect_buffer_usage, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent );
+          frame_resources->IndirectDrawBufferCoherent = true;
+        } catch( ... ) {
+          frame_resources->IndirectDrawBuffer.Buffer = SampleCommon::CreateBuffer( indirect_buffer_size, indirect_buffer_usage, vk::MemoryPropertyFlagBits::eHostVisible );
+          frame_resources->IndirectDrawBufferCoherent = false;
+        }
+        frame_resources->IndirectDrawBuffer.Pointer = GetDevice().mapMemory( *frame_resources->IndirectDrawBuffer.Buffer.Memory, 0, VK_WHOLE_SIZE );
+      }
     }
 
     OnSampleWindowSizeChanged_Post();
@@ -236,9 +1348,11 @@ namespace ApiWithoutSecrets {
         VK_SUBPASS_EXTERNAL,                                        // uint32_t                       srcSubpass
         0,                                                          // uint32_t                       dstSubpass
         vk::PipelineStageFlagBits::eColorAttachmentOutput,          // VkPipelineStageFlags           srcStageMask
-        vk::PipelineStageFlagBits::eColorAttachmentOutput,          // VkPipelineStageFlags           dstStageMask
+        vk::PipelineStageFlagBits::eColorAttachmentOutput |         // VkPipelineStageFlags           dstStageMask
+        vk::PipelineStageFlagBits::eEarlyFragmentTests,
         vk::AccessFlagBits::eColorAttachmentWrite,                  // VkAccessFlags                  srcAccessMask
-        vk::AccessFlagBits::eColorAttachmentWrite,                  // VkAccessFlags                  dstAccessMask
+        vk::AccessFlagBits::eColorAttachmentWrite |                 // VkAccessFlags                  dstAccessMask
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
         vk::DependencyFlagBits::eByRegion                           // VkDependencyFlags              dependencyFlags
       },
       {
@@ -251,45 +1365,77 @@ namespace ApiWithoutSecrets {
         vk::DependencyFlagBits::eByRegion                           // VkDependencyFlags              dependencyFlags
       }
     };
-    // Render pass - from present_src to color_attachment
+    // Render pass - from undefined to color_attachment (attachments are cleared so their previous contents are not needed)
     {
       std::vector<RenderPassAttachmentData> attachment_descriptions = {
         {
           GetSwapChain().Format,                                    // VkFormat                       format
           vk::AttachmentLoadOp::eClear,                             // VkAttachmentLoadOp             loadOp
           vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
-          vk::ImageLayout::ePresentSrcKHR,                          // VkImageLayout                  initialLayout
+          vk::ImageLayout::eUndefined,                              // VkImageLayout                  initialLayout
           vk::ImageLayout::eColorAttachmentOptimal                  // VkImageLayout                  finalLayout
         },
         {
           SampleCommon::DefaultDepthFormat,                         // VkFormat                       format
           vk::AttachmentLoadOp::eClear,                             // VkAttachmentLoadOp             loadOp
           vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
+          vk::ImageLayout::eUndefined,                              // VkImageLayout                  initialLayout
+          vk::ImageLayout::eDepthStencilAttachmentOptimal           // VkImageLayout                  finalLayout
+        }
+      };
+      Parameters.RenderPass = SampleCommon::CreateRenderPass( attachment_descriptions, subpass_descriptions, dependencies );
+    }
+    // Post-render pass - from color_attachment to present_src
+    {
+      std::vector<RenderPassAttachmentData> attachment_descriptions = {
+        {
+          GetSwapChain().Format,                                    // VkFormat                       format
+          vk::AttachmentLoadOp::eLoad,                              // VkAttachmentLoadOp             loadOp
+          vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
+          vk::ImageLayout::eColorAttachmentOptimal,                 // VkImageLayout                  initialLayout
+          vk::ImageLayout::ePresentSrcKHR                           // VkImageLayout                  finalLayout
+        },
+        {
+          SampleCommon::DefaultDepthFormat,                         // VkFormat                       format
+          vk::AttachmentLoadOp::eDontCare,                          // VkAttachmentLoadOp             loadOp
+          vk::AttachmentStoreOp::eDontCare,                         // VkAttachmentStoreOp            storeOp
           vk::ImageLayout::eDepthStencilAttachmentOptimal,          // VkImageLayout                  initialLayout
           vk::ImageLayout::eDepthStencilAttachmentOptimal           // VkImageLayout                  finalLayout
         }
       };
-      Parameters.RenderPass = SampleCommon::CreateRenderPass( attachment_descriptions, subpass_descriptions, dependencies );
+      Parameters.PostRenderPass = SampleCommon::CreateRenderPass( attachment_descriptions, subpass_descriptions, dependencies );
     }
-    // Post-render pass - from color_attachment to present_src
+    // Offscreen scene render pass - compatible with the render pass above, color attachment is then a source of an upscaling blit
     {
       std::vector<RenderPassAttachmentData> attachment_descriptions = {
         {
           GetSwapChain().Format,                                    // VkFormat                       format
-          vk::AttachmentLoadOp::eLoad,                              // VkAttachmentLoadOp             loadOp
+          vk::AttachmentLoadOp::eClear,                             // VkAttachmentLoadOp             loadOp
           vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
-          vk::ImageLayout::eColorAttachmentOptimal,                 // VkImageLayout                  initialLayout
-          vk::ImageLayout::ePresentSrcKHR                           // VkImageLayout                  finalLayout
+          vk::ImageLayout::eUndefined,                              // VkImageLayout                  initialLayout
+          vk::ImageLayout::eTransferSrcOptimal                      // VkImageLayout                  finalLayout
         },
         {
           SampleCommon::DefaultDepthFormat,                         // VkFormat                       format
-          vk::AttachmentLoadOp::eDontCare,                          // VkAttachmentLoadOp             loadOp
-          vk::AttachmentStoreOp::eDontCare,                         // VkAttachmentStoreOp            storeOp
-          vk::ImageLayout::eDepthStencilAttachmentOptimal,          // VkImageLayout                  initialLayout
+          vk::AttachmentLoadOp::eClear,                             // VkAttachmentLoadOp             loadOp
+          vk::AttachmentStoreOp::eStore,                            // VkAttachmentStoreOp            storeOp
+          vk::ImageLayout::eUndefined,                              // VkImageLayout                  initialLayout
           vk::ImageLayout::eDepthStencilAttachmentOptimal           // VkImageLayout                  finalLayout
         }
       };
-      Parameters.PostRenderPass = SampleCommon::CreateRenderPass( attachment_descriptions, subpass_descriptions, dependencies );
+      std::vector<vk::SubpassDependency> scene_dependencies = {
+        dependencies[0],
+        {
+          0,                                                        // uint32_t                       srcSubpass
+          VK_SUBPASS_EXTERNAL,                                      // uint32_t                       dstSubpass
+          vk::PipelineStageFlagBits::eColorAttachmentOutput,        // VkPipelineStageFlags           srcStageMask
+          vk::PipelineStageFlagBits::eTransfer,                     // VkPipelineStageFlags           dstStageMask
+          vk::AccessFlagBits::eColorAttachmentWrite,                // VkAccessFlags                  srcAccessMask
+          vk::AccessFlagBits::eTransferRead,                        // VkAccessFlags                  dstAccessMask
+          vk::DependencyFlags( 0 )                                  // VkDependencyFlags              dependencyFlags
+        }
+      };
+      Parameters.SceneRenderPass = SampleCommon::CreateRenderPass( attachment_descriptions, subpass_descriptions, scene_dependencies );
     }
   }
 
@@ -317,87 +1463,218 @@ namespace ApiWithoutSecrets {
       }
     };
     Parameters.DescriptorSet = SampleCommon::CreateDescriptorResources( layout_bindings, pool_sizes );
+    Parameters.AlternateDescriptorSet = SampleCommon::CreateDescriptorResources( layout_bindings, pool_sizes );
+
+    // Large, partially bound texture array which can be written while it is in use
+    Parameters.BindlessSupported = IsDescriptorIndexingEnabled();
+    if( Parameters.BindlessSupported ) {
+      std::vector<vk::DescriptorSetLayoutBinding> bindless_layout_bindings = {
+        {
+          0,                                                        // uint32_t                       binding
+          vk::DescriptorType::eCombinedImageSampler,                // VkDescriptorType               descriptorType
+          Parameters.MaxBindlessTexturesCount,                      // uint32_t                       descriptorCount
+          vk::ShaderStageFlagBits::eFragment,                       // VkShaderStageFlags             stageFlags
+          nullptr                                                   // const VkSampler               *pImmutableSamplers
+        }
+      };
+      std::vector<vk::DescriptorPoolSize> bindless_pool_sizes = {
+        {
+          vk::DescriptorType::eCombinedImageSampler,                // VkDescriptorType               type
+          Parameters.MaxBindlessTexturesCount                       // uint32_t                       descriptorCount
+        }
+      };
+      Parameters.BindlessDescriptorSet = SampleCommon::CreateDescriptorResources( bindless_layout_bindings, bindless_pool_sizes, true );
+    }
   }
 
   void Sample::CreateTextures() {
-    // Background texture
+    CreateTexture( "Data/Common/Background", Parameters.BackgroundTexture );
+    CreateTexture( "Data/" PROJECT_NUMBER_STRING "/FrameResources", Parameters.Texture );
+
+    // Sampler reading only the base level, used for comparison with trilinear filtering
+    Parameters.BaseLevelSampler = SampleCommon::CreateSampler( vk::SamplerMipmapMode::eNearest, vk::SamplerAddressMode::eClampToEdge, VK_FALSE );
+
+    UpdateTextureDescriptors();
+
+    // Textures are registered in pairs, instance's texture is drawn on top of the other one from its pair (see shader_bindless.frag)
+    if( Parameters.BindlessSupported ) {
+      RegisterBindlessTexture( Parameters.Texture );
+      RegisterBindlessTexture( Parameters.BackgroundTexture );
+    }
+  }
+
+  void Sample::CreateTexture( std::string const & filename, ImageParameters & texture ) {
+    // Prefer pre-compressed data; fall back to RGBA8 if it is not available or its format is not supported
+    if( CreateCompressedTexture( filename + ".ktx2", texture ) ) {
+      return;
+    }
+
+    int width = 0, height = 0, data_size = 0;
+    std::vector<char> texture_data = Tools::GetImageData( filename + ".png", 4, &width, &height, nullptr, &data_size );
+    uint32_t mip_levels = Tools::GetMipLevelsCount( width, height );
+    vk::Format format = vk::Format::eR8G8B8A8Unorm;
+
+    // Create descriptor resources
     {
-      int width = 0, height = 0, data_size = 0;
-      std::vector<char> texture_data = Tools::GetImageData( "Data/Common/Background.png", 4, &width, &height, nullptr, &data_size );
-      // Create descriptor resources
-      {
-        Parameters.BackgroundTexture = SampleCommon::CreateImage( width, height, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eColor );
-        Parameters.BackgroundTexture.Sampler = SampleCommon::CreateSampler( vk::SamplerMipmapMode::eNearest, vk::SamplerAddressMode::eClampToEdge, VK_FALSE );
-      }
-      // Copy data
-      {
-        vk::ImageSubresourceRange image_subresource_range(
-          vk::ImageAspectFlagBits::eColor,                              // VkImageAspectFlags             aspectMask
-          0,                                                            // uint32_t                       baseMipLevel
-          1,                                                            // uint32_t                       levelCount
-          0,                                                            // uint32_t                       baseArrayLayer
-          1                                                             // uint32_t                       layerCount
-        );
-        SampleCommon::CopyDataToImage( data_size, texture_data.data(), *Parameters.BackgroundTexture.Handle, width, height, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eFragmentShader );
-      }
-      // Update descriptor set
-      {
-        std::vector<vk::DescriptorImageInfo> image_infos = {
-          {
-            *Parameters.BackgroundTexture.Sampler,                      // VkSampler                      sampler
-            *Parameters.BackgroundTexture.View,                         // VkImageView                    imageView
-            vk::ImageLayout::eShaderReadOnlyOptimal                     // VkImageLayout                  imageLayout
-          }
-        };
-        SampleCommon::UpdateDescriptorSet( *Parameters.DescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, 0, 0, image_infos );
-      }
+      texture = SampleCommon::CreateImage( width, height, format, vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eColor, mip_levels );
+      texture.Sampler = SampleCommon::CreateSampler( vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode::eClampToEdge, VK_FALSE, static_cast<float>(mip_levels) );
+    }
+    // Copy data and generate mipmaps
+    if( SampleCommon::IsLinearBlitSupported( format ) ) {
+      // Upload base level and downsample it on the GPU with a chain of blits
+      vk::ImageSubresourceRange image_subresource_range(
+        vk::ImageAspectFlagBits::eColor,                                // VkImageAspectFlags             aspectMask
+        0,                                                              // uint32_t                       baseMipLevel
+        1,                                                              // uint32_t                       levelCount
+        0,                                                              // uint32_t                       baseArrayLayer
+        1                                                               // uint32_t                       layerCount
+      );
+      SampleCommon::CopyDataToImage( data_size, texture_data.data(), *texture.Handle, width, height, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer );
+      SampleCommon::GenerateMipmaps( *texture.Handle, format, width, height, mip_levels, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eFragmentShader );
+    } else {
+      // Linear blits are not available - downsample on the CPU and upload all levels at once
+      std::vector<uint32_t> level_offsets;
+      std::vector<char> mipmaps_data = Tools::GenerateMipmapsData( texture_data.data(), width, height, mip_levels, level_offsets );
+
+      vk::ImageSubresourceRange image_subresource_range(
+        vk::ImageAspectFlagBits::eColor,                                // VkImageAspectFlags             aspectMask
+        0,                                                              // uint32_t                       baseMipLevel
+        mip_levels,                                                     // uint32_t                       levelCount
+        0,                                                              // uint32_t                       baseArrayLayer
+        1                                                               // uint32_t                       layerCount
+      );
+      SampleCommon::CopyDataToImage( static_cast<uint32_t>(mipmaps_data.size()), mipmaps_data.data(), *texture.Handle, width, height, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eFragmentShader, level_offsets );
+    }
+  }
+
+  bool Sample::CreateCompressedTexture( std::string const & filename, ImageParameters & texture ) {
+    // Sample doesn't ship KTX2 versions of its textures, so a missing file silently selects uncompressed ones
+    if( !Tools::FileExists( filename ) ) {
+      return false;
     }
-    // Sample texture
+    Tools::KTX2ImageData image_data;
+    try {
+      image_data = Tools::GetKTX2ImageData( filename );
+    } catch( std::exception & exception ) {
+      std::cout << exception.what() << std::endl;
+      return false;
+    }
+
+    // Compressed format can be used only if its family's feature was enabled on the device
+    if( !IsTextureCompressionEnabled( image_data.Format ) ||
+        !SampleCommon::IsFormatFeatureSupported( image_data.Format, vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear ) ) {
+      return false;
+    }
+    // Mipmaps requested by the file are generated with blits, which block-compressed formats usually don't support
+    if( image_data.GenerateMipmaps &&
+        !SampleCommon::IsFormatFeatureSupported( image_data.Format, vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst ) ) {
+      return false;
+    }
+    uint32_t mip_levels = image_data.GenerateMipmaps ? Tools::GetMipLevelsCount( image_data.Width, image_data.Height ) : image_data.MipLevels;
+
+    // Create descriptor resources
     {
-      int width = 0, height = 0, data_size = 0;
-      std::vector<char> texture_data = Tools::GetImageData( "Data/" PROJECT_NUMBER_STRING "/FrameResources.png", 4, &width, &height, nullptr, &data_size );
-      // Create descriptor resources
-      {
-        Parameters.Texture = SampleCommon::CreateImage( width, height, vk::Format::eR8G8B8A8Unorm, vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eColor );
-        Parameters.Texture.Sampler = SampleCommon::CreateSampler( vk::SamplerMipmapMode::eNearest, vk::SamplerAddressMode::eClampToEdge, VK_FALSE );
-      }
-      // Copy data
-      {
-        vk::ImageSubresourceRange image_subresource_range(
-          vk::ImageAspectFlagBits::eColor,                              // VkImageAspectFlags             aspectMask
-          0,                                                            // uint32_t                       baseMipLevel
-          1,                                                            // uint32_t                       levelCount
-          0,                                                            // uint32_t                       baseArrayLayer
-          1                                                             // uint32_t                       layerCount
-        );
-        SampleCommon::CopyDataToImage( data_size, texture_data.data(), *Parameters.Texture.Handle, width, height, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eFragmentShader );
-      }
-      // Update descriptor set
-      {
-        std::vector<vk::DescriptorImageInfo> image_infos = {
-          {
-            *Parameters.Texture.Sampler,                                  // VkSampler                      sampler
-            *Parameters.Texture.View,                                     // VkImageView                    imageView
-            vk::ImageLayout::eShaderReadOnlyOptimal                       // VkImageLayout                  imageLayout
-          }
-        };
-        SampleCommon::UpdateDescriptorSet( *Parameters.DescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, 1, 0, image_infos );
-      }
+      texture = SampleCommon::CreateImage( image_data.Width, image_data.Height, image_data.Format, vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eColor, mip_levels );
+      texture.Sampler = SampleCommon::CreateSampler( vk::SamplerMipmapMode::eLinear, vk::SamplerAddressMode::eClampToEdge, VK_FALSE, static_cast<float>(mip_levels) );
+    }
+    if( image_data.GenerateMipmaps ) {
+      // Upload base level and downsample it on the GPU with a chain of blits
+      vk::ImageSubresourceRange image_subresource_range(
+        vk::ImageAspectFlagBits::eColor,                                // VkImageAspectFlags             aspectMask
+        0,                                                              // uint32_t                       baseMipLevel
+        1,                                                              // uint32_t                       levelCount
+        0,                                                              // uint32_t                       baseArrayLayer
+        1                                                               // uint32_t                       layerCount
+      );
+      SampleCommon::CopyDataToImage( static_cast<uint32_t>(image_data.Data.size()), image_data.Data.data(), *texture.Handle, image_data.Width, image_data.Height, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::eTransferSrcOptimal, vk::AccessFlagBits::eTransferRead, vk::PipelineStageFlagBits::eTransfer );
+      SampleCommon::GenerateMipmaps( *texture.Handle, image_data.Format, image_data.Width, image_data.Height, mip_levels, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eFragmentShader );
+    } else {
+      // Copy blocks of all levels directly
+      vk::ImageSubresourceRange image_subresource_range(
+        vk::ImageAspectFlagBits::eColor,                                // VkImageAspectFlags             aspectMask
+        0,                                                              // uint32_t                       baseMipLevel
+        image_data.MipLevels,                                           // uint32_t                       levelCount
+        0,                                                              // uint32_t                       baseArrayLayer
+        1                                                               // uint32_t                       layerCount
+      );
+      SampleCommon::CopyDataToImage( static_cast<uint32_t>(image_data.Data.size()), image_data.Data.data(), *texture.Handle, image_data.Width, image_data.Height, image_subresource_range, vk::ImageLayout::eUndefined, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eFragmentShader, image_data.LevelOffsets );
+    }
+    return true;
+  }
+
+  void Sample::UpdateTextureDescriptors() {
+    std::vector<ImageParameters const *> textures = {
+      &Parameters.BackgroundTexture,
+      &Parameters.Texture
+    };
+
+    // All texture descriptors, including the whole bindless table, are written with a single call
+    DescriptorWriter writer;
+    for( uint32_t i = 0; i < static_cast<uint32_t>(textures.size()); ++i ) {
+      vk::DescriptorImageInfo image_info(
+        Parameters.UseMipmaps ? *textures[i]->Sampler : *Parameters.BaseLevelSampler, // VkSampler              sampler
+        *textures[i]->View,                                               // VkImageView                    imageView
+        vk::ImageLayout::eShaderReadOnlyOptimal                           // VkImageLayout                  imageLayout
+      );
+      writer.WriteImage( *Parameters.DescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, i, 0, image_info );
+      // Alternate set references the same textures in the same bindings, so only the bound set changes, not the image
+      writer.WriteImage( *Parameters.AlternateDescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, i, 0, image_info );
+    }
+
+    for( uint32_t i = 0; i < static_cast<uint32_t>(Parameters.BindlessTextureTable.size()); ++i ) {
+      WriteBindlessTextureDescriptor( writer, i );
+    }
+    writer.Flush( GetDevice() );
+  }
+
+  uint32_t Sample::RegisterBindlessTexture( ImageParameters const & texture ) {
+    if( Parameters.BindlessTextureTable.size() >= Parameters.MaxBindlessTexturesCount ) {
+      throw std::exception( "Could not register a texture - bindless texture table is full!" );
     }
+    Parameters.BindlessTextureTable.push_back( &texture );
+
+    // Update-after-bind descriptors may be written while the set is used by frames in flight, as long as those frames don't access them
+    uint32_t index = static_cast<uint32_t>(Parameters.BindlessTextureTable.size() - 1);
+    DescriptorWriter writer;
+    WriteBindlessTextureDescriptor( writer, index );
+    writer.Flush( GetDevice() );
+    return index;
+  }
+
+  void Sample::WriteBindlessTextureDescriptor( DescriptorWriter & writer, uint32_t index ) const {
+    ImageParameters const & texture = *Parameters.BindlessTextureTable[index];
+    vk::DescriptorImageInfo image_info(
+      Parameters.UseMipmaps ? *texture.Sampler : *Parameters.BaseLevelSampler, // VkSampler                   sampler
+      *texture.View,                                                      // VkImageView                    imageView
+      vk::ImageLayout::eShaderReadOnlyOptimal                             // VkImageLayout                  imageLayout
+    );
+    // Consecutive table entries are merged by the writer into a single write of an array range
+    writer.WriteImage( *Parameters.BindlessDescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, 0, index, image_info );
   }
 
   void Sample::CreatePipelineLayout() {
     vk::PushConstantRange push_constant_ranges(
       vk::ShaderStageFlagBits::eVertex,                                 // VkShaderStageFlags             stageFlags
       0,                                                                // uint32_t                       offset
-      4                                                                 // uint32_t                       size
+      12                                                                // uint32_t                       size
     );
-    Parameters.PipelineLayout = SampleCommon::CreatePipelineLayout( { *Parameters.DescriptorSet.Layout }, { push_constant_ranges } );
+    // Set 0 - textures, set 1 - per-instance records; all frame resources use the same layout of instance descriptor sets
+    Parameters.PipelineLayout = SampleCommon::CreatePipelineLayout( { *Parameters.DescriptorSet.Layout, *SAMPLE_FRAME_RESOURCES_PTR( 0 )->InstanceDescriptorSet.Layout }, { push_constant_ranges } );
+    if( Parameters.BindlessSupported ) {
+      Parameters.BindlessPipelineLayout = SampleCommon::CreatePipelineLayout( { *Parameters.BindlessDescriptorSet.Layout, *SAMPLE_FRAME_RESOURCES_PTR( 0 )->InstanceDescriptorSet.Layout }, { push_constant_ranges } );
+    }
   }
 
   void Sample::CreateGraphicsPipeline() {
+    Parameters.Pipelines = CreateScenePipelines( *Parameters.PipelineLayout, "Data/" PROJECT_NUMBER_STRING "/shader.frag.spv" );
+    if( Parameters.BindlessSupported ) {
+      Parameters.BindlessPipelines = CreateScenePipelines( *Parameters.BindlessPipelineLayout, "Data/" PROJECT_NUMBER_STRING "/shader_bindless.frag.spv" );
+    }
+  }
+
+  ScenePipelinesData Sample::CreateScenePipelines( vk::PipelineLayout const & pipeline_layout, char const * fragment_shader_filename ) const {
     vk::UniqueShaderModule vertex_shader_module = SampleCommon::CreateShaderModule( "Data/" PROJECT_NUMBER_STRING "/shader.vert.spv" );
-    vk::UniqueShaderModule fragment_shader_module = SampleCommon::CreateShaderModule( "Data/" PROJECT_NUMBER_STRING "/shader.frag.spv" );
+    vk::UniqueShaderModule fragment_shader_module = SampleCommon::CreateShaderModule( fragment_shader_filename );
 
     std::vector<vk::PipelineShaderStageCreateInfo> shader_stage_create_infos = {
       // Vertex shader
@@ -421,11 +1698,6 @@ namespace ApiWithoutSecrets {
         0,                                                          // uint32_t                                       binding
         sizeof( VertexData ),                                       // uint32_t                                       stride
         vk::VertexInputRate::eVertex                                // VkVertexInputRate                              inputRate
-      },
-      {
-        1,                                                          // uint32_t                                       binding
-        4 * sizeof( float ),                                        // uint32_t                                       stride
-        vk::VertexInputRate::eInstance                              // VkVertexInputRate                              inputRate
       }
     };
 
@@ -441,12 +1713,6 @@ namespace ApiWithoutSecrets {
         vertex_binding_description[0].binding,                      // uint32_t                                       binding
         vk::Format::eR32G32Sfloat,                                  // VkFormat                                       format
         reinterpret_cast<size_t>(&((VertexData*)0)->Texcoords)      // uint32_t                                       offset
-      },
-      {
-        2,                                                          // uint32_t                                       location
-        vertex_binding_description[1].binding,                      // uint32_t                                       binding
-        vk::Format::eR32G32B32A32Sfloat,                            // VkFormat                                       format
-        0                                                           // uint32_t                                       offset
       }
     };
 
@@ -549,77 +1815,453 @@ namespace ApiWithoutSecrets {
       &depth_stencil_state_create_info,                             // const VkPipelineDepthStencilStateCreateInfo   *pDepthStencilState
       &color_blend_state_create_info,                               // const VkPipelineColorBlendStateCreateInfo     *pColorBlendState
       &dynamic_state_create_info,                                   // const VkPipelineDynamicStateCreateInfo        *pDynamicState
-      *Parameters.PipelineLayout,                                   // VkPipelineLayout                               layout
+      pipeline_layout,                                              // VkPipelineLayout                               layout
       *Parameters.RenderPass,                                       // VkRenderPass                                   renderPass
       0,                                                            // uint32_t                                       subpass
       vk::Pipeline(),                                               // VkPipeline                                     basePipelineHandle
       -1                                                            // int32_t                                        basePipelineIndex
     );
-    Parameters.GraphicsPipeline = GetDevice().createGraphicsPipelineUnique( vk::PipelineCache(), pipeline_create_info );
+    ScenePipelinesData pipelines;
+    pipelines.Default = GetDevice().createGraphicsPipelineUnique( vk::PipelineCache(), pipeline_create_info );
+
+    // Quads face the viewer so the variant without culling produces the same image, but it is a separate state to bind
+    rasterization_state_create_info.cullMode = vk::CullModeFlagBits::eNone;
+    pipelines.Alternate = GetDevice().createGraphicsPipelineUnique( vk::PipelineCache(), pipeline_create_info );
+
+    // Procedural variants compute positions and texture coordinates from a vertex index and don't read any vertex attributes
+    vk::UniqueShaderModule procedural_vertex_shader_module = SampleCommon::CreateShaderModule( "Data/" PROJECT_NUMBER_STRING "/shader_procedural.vert.spv" );
+    shader_stage_create_infos[0].module = *procedural_vertex_shader_module;
+
+    vk::PipelineVertexInputStateCreateInfo procedural_vertex_input_state_create_info;
+    pipeline_create_info.pVertexInputState = &procedural_vertex_input_state_create_info;
+
+    rasterization_state_create_info.cullMode = vk::CullModeFlagBits::eBack;
+    pipelines.Procedural = GetDevice().createGraphicsPipelineUnique( vk::PipelineCache(), pipeline_create_info );
+    rasterization_state_create_info.cullMode = vk::CullModeFlagBits::eNone;
+    pipelines.ProceduralAlternate = GetDevice().createGraphicsPipelineUnique( vk::PipelineCache(), pipeline_create_info );
+    return pipelines;
   }
 
   void Sample::CreateVertexBuffers() {
-    // 3D model
-    std::vector<VertexData> vertex_data;
+    // 3D model - levels of detail of a quad grid are packed into a single geometry arena,
+    // each level halves tessellation of a previous one
+    GeometryArena arena( sizeof( VertexData ) );
+    const float size = Parameters.QuadSize;
+    for( int level = 0; level < Parameters.LodLevelsCount; ++level ) {
+      int tessellation = std::max( Parameters.QuadTessellation >> level, 1 );
+      float step = 2.0f * size / tessellation;
+
+      std::vector<VertexData> vertex_data;
+      for( int x = 0; x <= tessellation; ++x ) {
+        for( int y = 0; y <= tessellation; ++y ) {
+          vertex_data.push_back(
+          {
+            { -size + x * step, -size + y * step, 0.0f, 1.0f },
+            { static_cast<float>(x) / tessellation, static_cast<float>(y) / tessellation }
+          } );
+        }
+      }
+
+      // Triangles are ordered the same way as vertices generated in shader_procedural.vert
+      std::vector<uint32_t> index_data;
+      for( int x = 0; x < tessellation; ++x ) {
+        for( int y = 0; y < tessellation; ++y ) {
+          uint32_t corner = static_cast<uint32_t>(x * (tessellation + 1) + y);
+          uint32_t row = static_cast<uint32_t>(tessellation + 1);
+          index_data.insert( index_data.end(), { corner, corner + 1, corner + row, corner + row, corner + 1, corner + row + 1 } );
+        }
+      }
+      Parameters.QuadLodMeshes[level] = arena.AddMesh( vertex_data.data(), static_cast<uint32_t>(vertex_data.size()), index_data );
+    }
+    Parameters.Geometry = SampleCommon::CreateGeometryArena( arena );
+
+    // Per instance data (position offsets, distance, scale, tint color and texture) - instances initially cover the
+    // screen, visible ones are copied to per-frame instance buffers during rendering
+    auto & instances = Parameters.Instances;
+    instances.BaseX.resize( Parameters.MaxObjectsCount );
+    instances.BaseY.resize( Parameters.MaxObjectsCount );
+    instances.X.resize( Parameters.MaxObjectsCount );
+    instances.Y.resize( Parameters.MaxObjectsCount );
+    instances.Z.resize( Parameters.MaxObjectsCount );
+    instances.Scale.resize( Parameters.MaxObjectsCount );
+    instances.Color.resize( Parameters.MaxObjectsCount );
+    instances.TextureIndex.resize( Parameters.MaxObjectsCount );
+    instances.Radius.resize( Parameters.MaxObjectsCount );
+    for( int i = 0; i < Parameters.MaxObjectsCount; ++i ) {
+      instances.BaseX[i] = static_cast<float>(std::rand() % 4097) / 2048.0f - 1.0f;
+      instances.BaseY[i] = static_cast<float>(std::rand() % 4097) / 2048.0f - 1.0f;
+      instances.Z[i] = static_cast<float>(std::rand() % 513) / 512.0f;
+      instances.Scale[i] = 0.75f + static_cast<float>(std::rand() % 513) / 1024.0f;
+      // Light tints keep textures recognizable
+      uint32_t red = 160 + std::rand() % 96;
+      uint32_t green = 160 + std::rand() % 96;
+      uint32_t blue = 160 + std::rand() % 96;
+      instances.Color[i] = red | (green << 8) | (blue << 16) | (255u << 24);
+      instances.TextureIndex[i] = (std::rand() % 4 == 0) ? 1 : 0;
+    }
+    PlaceInstances();
+    Parameters.VisibleInstances.resize( Parameters.MaxObjectsCount );
+    Parameters.InstanceLodLevels.resize( Parameters.MaxObjectsCount );
+    Parameters.LodSortedInstances.resize( Parameters.MaxObjectsCount );
+  }
+
+  Sample::~Sample() {
+    StopSimulationThread();
+    if( GetDevice() ) {
+      GetDevice().waitIdle();
+    }
+  }
+
+  void Sample::CreateDepthPyramid() {
+    // Pyramid may still be used by frames in flight so it is released later
+    SampleCommon::DeferDestruction( std::move( Parameters.DepthPyramid ) );
+    Parameters.DepthPyramid = DepthPyramidData();
+    auto & pyramid = Parameters.DepthPyramid;
+
+    // Level 0 has half the size of depth attachments, conservative downsampling handles odd sizes
+    pyramid.Width = std::max( (GetSwapChain().Extent.width + 1) / 2, 1u );
+    pyramid.Height = std::max( (GetSwapChain().Extent.height + 1) / 2, 1u );
+    pyramid.LevelsCount = Tools::GetMipLevelsCount( pyramid.Width, pyramid.Height );
+    pyramid.Image = SampleCommon::CreateImage( pyramid.Width, pyramid.Height, vk::Format::eR32Sfloat, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eStorage, vk::MemoryPropertyFlagBits::eDeviceLocal, vk::ImageAspectFlagBits::eColor, pyramid.LevelsCount );
+    pyramid.Image.Sampler = SampleCommon::CreateSampler( vk::SamplerMipmapMode::eNearest, vk::SamplerAddressMode::eClampToEdge, VK_FALSE, static_cast<float>(pyramid.LevelsCount) );
+
+    // Each level is written through a separate view
+    for( uint32_t level = 0; level < pyramid.LevelsCount; ++level ) {
+      vk::ImageViewCreateInfo image_view_create_info(
+        vk::ImageViewCreateFlags( 0 ),                                // VkImageViewCreateFlags         flags
+        *pyramid.Image.Handle,                                        // VkImage                        image
+        vk::ImageViewType::e2D,                                       // VkImageViewType                viewType
+        vk::Format::eR32Sfloat,                                       // VkFormat                       format
+        vk::ComponentMapping(),                                       // VkComponentMapping             components
+        {                                                             // VkImageSubresourceRange        subresourceRange
+          vk::ImageAspectFlagBits::eColor,                              // VkImageAspectFlags             aspectMask
+          level,                                                        // uint32_t                       baseMipLevel
+          1,                                                            // uint32_t                       levelCount
+          0,                                                            // uint32_t                       baseArrayLayer
+          1                                                             // uint32_t                       layerCount
+        }
+      );
+      pyramid.LevelViews.push_back( GetDevice().createImageViewUnique( image_view_create_info ) );
+    }
+    pyramid.LevelDescriptorSets.resize( pyramid.LevelsCount );
+    for( uint32_t level = 1; level < pyramid.LevelsCount; ++level ) {
+      pyramid.LevelDescriptorSets[level] = CreateDepthDownsampleDescriptorSet( *pyramid.LevelViews[level - 1], vk::ImageLayout::eGeneral, *pyramid.LevelViews[level] );
+    }
+
+    // Descriptor sets can't be updated while they are used so new ones are created for each frame resource
+    for( size_t i = 0; i < FrameResources.size(); ++i ) {
+      auto frame_resources = SAMPLE_FRAME_RESOURCES_PTR( i );
+      SampleCommon::DeferDestruction( std::move( frame_resources->DepthDownsampleDescriptorSet ) );
+      SampleCommon::DeferDestruction( std::move( frame_resources->OcclusionCullingDescriptorSet ) );
+      frame_resources->DepthDownsampleDescriptorSet = CreateDepthDownsampleDescriptorSet( *frame_resources->DepthAttachment.View, vk::ImageLayout::eDepthStencilReadOnlyOptimal, *pyramid.LevelViews[0] );
+      frame_resources->OcclusionCullingDescriptorSet = CreateOcclusionCullingDescriptorSet( *frame_resources );
+    }
+  }
+
+  DescriptorSetParameters Sample::CreateDepthDownsampleDescriptorSet( vk::ImageView const & source_view, vk::ImageLayout source_layout, vk::ImageView const & destination_view ) const {
+    std::vector<vk::DescriptorSetLayoutBinding> layout_bindings = {
+      {
+        0,                                                          // uint32_t                       binding
+        vk::DescriptorType::eCombinedImageSampler,                  // VkDescriptorType               descriptorType
+        1,                                                          // uint32_t                       descriptorCount
+        vk::ShaderStageFlagBits::eCompute,                          // VkShaderStageFlags             stageFlags
+        nullptr                                                     // const VkSampler               *pImmutableSamplers
+      },
+      {
+        1,                                                          // uint32_t                       binding
+        vk::DescriptorType::eStorageImage,                          // VkDescriptorType               descriptorType
+        1,                                                          // uint32_t                       descriptorCount
+        vk::ShaderStageFlagBits::eCompute,                          // VkShaderStageFlags             stageFlags
+        nullptr                                                     // const VkSampler               *pImmutableSamplers
+      }
+    };
+    std::vector<vk::DescriptorPoolSize> pool_sizes = {
+      {
+        vk::DescriptorType::eCombinedImageSampler,                  // VkDescriptorType               type
+        1                                                           // uint32_t                       descriptorCount
+      },
+      {
+        vk::DescriptorType::eStorageImage,                          // VkDescriptorType               type
+        1                                                           // uint32_t                       descriptorCount
+      }
+    };
+    DescriptorSetParameters descriptor_set = SampleCommon::CreateDescriptorResources( layout_bindings, pool_sizes );
+
+    vk::DescriptorImageInfo source_image_info(
+      *Parameters.DepthPyramid.Image.Sampler,                       // VkSampler                      sampler
+      source_view,                                                  // VkImageView                    imageView
+      source_layout                                                 // VkImageLayout                  imageLayout
+    );
+    vk::DescriptorImageInfo destination_image_info(
+      vk::Sampler(),                                                // VkSampler                      sampler
+      destination_view,                                             // VkImageView                    imageView
+      vk::ImageLayout::eGeneral                                     // VkImageLayout                  imageLayout
+    );
+    DescriptorWriter writer;
+    writer.WriteImage( *descriptor_set.Handle, vk::DescriptorType::eCombinedImageSampler, 0, 0, source_image_info );
+    writer.WriteImage( *descriptor_set.Handle, vk::DescriptorType::eStorageImage, 1, 0, destination_image_info );
+    writer.Flush( GetDevice() );
+    return descriptor_set;
+  }
+
+  DescriptorSetParameters Sample::CreateOcclusionCullingDescriptorSet( SampleFrameResourcesData const & frame_resources ) const {
+    std::vector<vk::DescriptorSetLayoutBinding> layout_bindings = {
+      {
+        0,                                                          // uint32_t                       binding
+        vk::DescriptorType::eCombinedImageSampler,                  // VkDescriptorType               descriptorType
+        1,                                                          // uint32_t                       descriptorCount
+        vk::ShaderStageFlagBits::eCompute,                          // VkShaderStageFlags             stageFlags
+        nullptr                                                     // const VkSampler               *pImmutableSamplers
+      },
+      {
+        1,                                                          // uint32_t                       binding
+        vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               descriptorType
+        1,                                                          // uint32_t                       descriptorCount
+        vk::ShaderStageFlagBits::eCompute,                          // VkShaderStageFlags             stageFlags
+        nullptr                                                     // const VkSampler               *pImmutableSamplers
+      },
+      {
+        2,                                                          // uint32_t                       binding
+        vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               descriptorType
+        1,                                                          // uint32_t                       descriptorCount
+        vk::ShaderStageFlagBits::eCompute,                          // VkShaderStageFlags             stageFlags
+        nullptr                                                     // const VkSampler               *pImmutableSamplers
+      },
+      {
+        3,                                                          // uint32_t                       binding
+        vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               descriptorType
+        1,                                                          // uint32_t                       descriptorCount
+        vk::ShaderStageFlagBits::eCompute,                          // VkShaderStageFlags             stageFlags
+        nullptr                                                     // const VkSampler               *pImmutableSamplers
+      }
+    };
+    std::vector<vk::DescriptorPoolSize> pool_sizes = {
+      {
+        vk::DescriptorType::eCombinedImageSampler,                  // VkDescriptorType               type
+        1                                                           // uint32_t                       descriptorCount
+      },
+      {
+        vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               type
+        3                                                           // uint32_t                       descriptorCount
+      }
+    };
+    DescriptorSetParameters descriptor_set = SampleCommon::CreateDescriptorResources( layout_bindings, pool_sizes );
 
-    const float size = 0.12f;
-    float step = 2.0f * size / Parameters.QuadTessellation;
-    for( int x = 0; x < Parameters.QuadTessellation; ++x ) {
-      for( int y = 0; y < Parameters.QuadTessellation; ++y ) {
-        float pos_x = -size + x * step;
-        float pos_y = -size + y * step;
+    OcclusionCullingDescriptorData descriptor_data = GetOcclusionCullingDescriptorData( frame_resources );
+    DescriptorWriter writer;
+    writer.WriteImage( *descriptor_set.Handle, vk::DescriptorType::eCombinedImageSampler, 0, 0, descriptor_data.DepthPyramid );
+    for( uint32_t i = 0; i < static_cast<uint32_t>(descriptor_data.Buffers.size()); ++i ) {
+      writer.WriteBuffer( *descriptor_set.Handle, vk::DescriptorType::eStorageBuffer, i + 1, 0, descriptor_data.Buffers[i] );
+    }
+    writer.Flush( GetDevice() );
+    return descriptor_set;
+  }
 
-        vertex_data.push_back(
+  OcclusionCullingDescriptorData Sample::GetOcclusionCullingDescriptorData( SampleFrameResourcesData const & frame_resources ) const {
+    OcclusionCullingDescriptorData descriptor_data = {
+      {
+        *Parameters.DepthPyramid.Image.Sampler,                     // VkSampler                      sampler
+        *Parameters.DepthPyramid.Image.View,                        // VkImageView                    imageView
+        vk::ImageLayout::eGeneral                                   // VkImageLayout                  imageLayout
+      },
+      // Input instances, instances which passed the test and the indirect draw command
+      { {
         {
-          { pos_x, pos_y, 0.0f, 1.0f },
-          { static_cast<float>(x) / (Parameters.QuadTessellation), static_cast<float>(y) / (Parameters.QuadTessellation) }
-        } );
-        vertex_data.push_back(
+          *frame_resources.InstanceBuffer.Buffer.Handle,            // VkBuffer                       buffer
+          0,                                                        // VkDeviceSize                   offset
+          VK_WHOLE_SIZE                                             // VkDeviceSize                   range
+        },
         {
-          { pos_x, pos_y + step, 0.0f, 1.0f },
-          { static_cast<float>(x) / (Parameters.QuadTessellation), static_cast<float>(y + 1) / (Parameters.QuadTessellation) }
-        } );
-        vertex_data.push_back(
+          *frame_resources.CulledInstanceBuffer.Handle,             // VkBuffer                       buffer
+          0,                                                        // VkDeviceSize                   offset
+          VK_WHOLE_SIZE                                             // VkDeviceSize                   range
+        },
         {
-          { pos_x + step, pos_y, 0.0f, 1.0f },
-          { static_cast<float>(x + 1) / (Parameters.QuadTessellation), static_cast<float>(y) / (Parameters.QuadTessellation) }
-        } );
-        vertex_data.push_back(
+          *frame_resources.IndirectDrawBuffer.Buffer.Handle,        // VkBuffer                       buffer
+          0,                                                        // VkDeviceSize                   offset
+          VK_WHOLE_SIZE                                             // VkDeviceSize                   range
+        }
+      } }
+    };
+    return descriptor_data;
+  }
+
+  DescriptorSetParameters Sample::CreateInstanceDescriptorSet( vk::Buffer const & instance_buffer ) const {
+    std::vector<vk::DescriptorSetLayoutBinding> layout_bindings = {
+      {
+        0,                                                          // uint32_t                       binding
+        vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               descriptorType
+        1,                                                          // uint32_t                       descriptorCount
+        vk::ShaderStageFlagBits::eVertex,                           // VkShaderStageFlags             stageFlags
+        nullptr                                                     // const VkSampler               *pImmutableSamplers
+      }
+    };
+    std::vector<vk::DescriptorPoolSize> pool_sizes = {
+      {
+        vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               type
+        1                                                           // uint32_t                       descriptorCount
+      }
+    };
+    DescriptorSetParameters descriptor_set = SampleCommon::CreateDescriptorResources( layout_bindings, pool_sizes );
+
+    std::vector<vk::DescriptorBufferInfo> buffer_infos = {
+      {
+        instance_buffer,                                            // VkBuffer                       buffer
+        0,                                                          // VkDeviceSize                   offset
+        VK_WHOLE_SIZE                                               // VkDeviceSize                   range
+      }
+    };
+    SampleCommon::UpdateDescriptorSet( *descriptor_set.Handle, vk::DescriptorType::eStorageBuffer, 0, 0, {}, buffer_infos );
+    return descriptor_set;
+  }
+
+  void Sample::CreateDescriptorUpdateTemplates() {
+    if( !IsDescriptorUpdateTemplateEnabled() ) {
+      return;
+    }
+
+    // Templates are created for layouts of the first frame resources, sets of all frames use identically defined layouts
+    auto frame_resources = SAMPLE_FRAME_RESOURCES_PTR( 0 );
+    {
+      std::vector<vk::DescriptorUpdateTemplateEntry> entries = {
         {
-          { pos_x + step, pos_y, 0.0f, 1.0f },
-          { static_cast<float>(x + 1) / (Parameters.QuadTessellation), static_cast<float>(y) / (Parameters.QuadTessellation) }
-        } );
-        vertex_data.push_back(
+          0,                                                          // uint32_t                       dstBinding
+          0,                                                          // uint32_t                       dstArrayElement
+          1,                                                          // uint32_t                       descriptorCount
+          vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               descriptorType
+          0,                                                          // size_t                         offset
+          sizeof( vk::DescriptorBufferInfo )                          // size_t                         stride
+        }
+      };
+      Parameters.InstanceUpdateTemplate = SampleCommon::CreateDescriptorUpdateTemplate( *frame_resources->InstanceDescriptorSet.Layout, entries );
+    }
+    if( Parameters.OcclusionCullingSupported ) {
+      // Storage buffers occupy consecutive bindings of the same type, so all of them are read by a single entry
+      std::vector<vk::DescriptorUpdateTemplateEntry> entries = {
         {
-          { pos_x, pos_y + step, 0.0f, 1.0f },
-          { static_cast<float>(x) / (Parameters.QuadTessellation), static_cast<float>(y + 1) / (Parameters.QuadTessellation) }
-        } );
-        vertex_data.push_back(
+          0,                                                          // uint32_t                       dstBinding
+          0,                                                          // uint32_t                       dstArrayElement
+          1,                                                          // uint32_t                       descriptorCount
+          vk::DescriptorType::eCombinedImageSampler,                  // VkDescriptorType               descriptorType
+          offsetof( OcclusionCullingDescriptorData, DepthPyramid ),   // size_t                         offset
+          sizeof( vk::DescriptorImageInfo )                           // size_t                         stride
+        },
         {
-          { pos_x + step, pos_y + step, 0.0f, 1.0f },
-          { static_cast<float>(x + 1) / (Parameters.QuadTessellation), static_cast<float>(y + 1) / (Parameters.QuadTessellation) }
-        } );
-      }
+          1,                                                          // uint32_t                       dstBinding
+          0,                                                          // uint32_t                       dstArrayElement
+          3,                                                          // uint32_t                       descriptorCount
+          vk::DescriptorType::eStorageBuffer,                         // VkDescriptorType               descriptorType
+          offsetof( OcclusionCullingDescriptorData, Buffers ),        // size_t                         offset
+          sizeof( vk::DescriptorBufferInfo )                          // size_t                         stride
+        }
+      };
+      Parameters.OcclusionCullingUpdateTemplate = SampleCommon::CreateDescriptorUpdateTemplate( *frame_resources->OcclusionCullingDescriptorSet.Layout, entries );
     }
-    Parameters.VertexBuffer = SampleCommon::CreateBuffer( static_cast<uint32_t>(vertex_data.size()) * sizeof( VertexData ), vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal );
-    SampleCommon::CopyDataToBuffer( static_cast<uint32_t>(vertex_data.size()) * sizeof( VertexData ), vertex_data.data(), *Parameters.VertexBuffer.Handle, 0, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::AccessFlagBits::eVertexAttributeRead, vk::PipelineStageFlagBits::eVertexInput );
+  }
 
-    // Per instance data (position offsets and distance)
-    std::vector<float> instance_data( Parameters.MaxObjectsCount * 4 );
-    for( size_t i = 0; i < instance_data.size(); i+=4 ) {
-      instance_data[i] = static_cast<float>(std::rand() % 513) / 256.0f - 1.0f;
-      instance_data[i + 1] = static_cast<float>(std::rand() % 513) / 256.0f - 1.0f;
-      instance_data[i + 2] = static_cast<float>(std::rand() % 513) / 512.0f;
-      instance_data[i + 3] = 0.0f;
+  void Sample::RewriteFrameDescriptorSets( SampleFrameResourcesData & frame_resources ) {
+    // Frame's fence was already waited on, so its descriptor sets aren't used by the GPU and may be written
+    vk::DescriptorBufferInfo instance_buffer_info(
+      *frame_resources.InstanceBuffer.Buffer.Handle,                // VkBuffer                       buffer
+      0,                                                            // VkDeviceSize                   offset
+      VK_WHOLE_SIZE                                                 // VkDeviceSize                   range
+    );
+    bool occlusion_culling_sets = Parameters.OcclusionCullingSupported;
+    OcclusionCullingDescriptorData occlusion_culling_data = {};
+    vk::DescriptorBufferInfo culled_instance_buffer_info;
+    if( occlusion_culling_sets ) {
+      occlusion_culling_data = GetOcclusionCullingDescriptorData( frame_resources );
+      culled_instance_buffer_info = occlusion_culling_data.Buffers[1];
+    }
+    uint32_t sets_count = occlusion_culling_sets ? 3 : 1;
+    int method = IsDescriptorUpdateTemplateEnabled() ? Parameters.DescriptorUpdateMethod : std::min( Parameters.DescriptorUpdateMethod, 1 );
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    switch( method ) {
+    case 0:
+      // One vkUpdateDescriptorSets() call per descriptor
+      SampleCommon::UpdateDescriptorSet( *frame_resources.InstanceDescriptorSet.Handle, vk::DescriptorType::eStorageBuffer, 0, 0, {}, { instance_buffer_info } );
+      if( occlusion_culling_sets ) {
+        SampleCommon::UpdateDescriptorSet( *frame_resources.CulledInstanceDescriptorSet.Handle, vk::DescriptorType::eStorageBuffer, 0, 0, {}, { culled_instance_buffer_info } );
+        SampleCommon::UpdateDescriptorSet( *frame_resources.OcclusionCullingDescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, 0, 0, { occlusion_culling_data.DepthPyramid } );
+        for( uint32_t i = 0; i < static_cast<uint32_t>(occlusion_culling_data.Buffers.size()); ++i ) {
+          SampleCommon::UpdateDescriptorSet( *frame_resources.OcclusionCullingDescriptorSet.Handle, vk::DescriptorType::eStorageBuffer, i + 1, 0, {}, { occlusion_culling_data.Buffers[i] } );
+        }
+      }
+      break;
+    case 1:
+      {
+        // Writes of all sets are accumulated and issued with a single call
+        DescriptorWriter & writer = Parameters.FrameDescriptorWriter;
+        writer.WriteBuffer( *frame_resources.InstanceDescriptorSet.Handle, vk::DescriptorType::eStorageBuffer, 0, 0, instance_buffer_info );
+        if( occlusion_culling_sets ) {
+          writer.WriteBuffer( *frame_resources.CulledInstanceDescriptorSet.Handle, vk::DescriptorType::eStorageBuffer, 0, 0, culled_instance_buffer_info );
+          writer.WriteImage( *frame_resources.OcclusionCullingDescriptorSet.Handle, vk::DescriptorType::eCombinedImageSampler, 0, 0, occlusion_culling_data.DepthPyramid );
+          for( uint32_t i = 0; i < static_cast<uint32_t>(occlusion_culling_data.Buffers.size()); ++i ) {
+            writer.WriteBuffer( *frame_resources.OcclusionCullingDescriptorSet.Handle, vk::DescriptorType::eStorageBuffer, i + 1, 0, occlusion_culling_data.Buffers[i] );
+          }
+        }
+        writer.Flush( GetDevice() );
+      }
+      break;
+    default:
+      // Whole set is read by the driver from memory laid out as described by a template
+      GetDevice().updateDescriptorSetWithTemplate( *frame_resources.InstanceDescriptorSet.Handle, *Parameters.InstanceUpdateTemplate, &instance_buffer_info );
+      if( occlusion_culling_sets ) {
+        GetDevice().updateDescriptorSetWithTemplate( *frame_resources.CulledInstanceDescriptorSet.Handle, *Parameters.InstanceUpdateTemplate, &culled_instance_buffer_info );
+        GetDevice().updateDescriptorSetWithTemplate( *frame_resources.OcclusionCullingDescriptorSet.Handle, *Parameters.OcclusionCullingUpdateTemplate, &occlusion_culling_data );
+      }
+      break;
     }
-    Parameters.InstanceBuffer = SampleCommon::CreateBuffer( static_cast<uint32_t>(instance_data.size()) * sizeof( float ), vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal );
-    SampleCommon::CopyDataToBuffer( static_cast<uint32_t>(instance_data.size()) * sizeof( float ), instance_data.data(), *Parameters.InstanceBuffer.Handle, 0, vk::AccessFlags( 0 ), vk::PipelineStageFlagBits::eTopOfPipe, vk::AccessFlagBits::eVertexAttributeRead, vk::PipelineStageFlagBits::eVertexInput );
+    auto update_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start_time);
+
+    float & time_per_set = Parameters.DescriptorUpdateTimes[method];
+    time_per_set = time_per_set * 0.99f + static_cast<float>(update_time.count() * 0.001f) / sets_count * 0.01f;
   }
 
-  Sample::~Sample() {
-    if( GetDevice() ) {
-      GetDevice().waitIdle();
+  void Sample::CreateOcclusionCullingPipelines() {
+    if( !Parameters.OcclusionCullingSupported ) {
+      return;
+    }
+
+    // Descriptor sets are recreated together with depth attachments but their layouts don't change
+    auto frame_resources = SAMPLE_FRAME_RESOURCES_PTR( 0 );
+    {
+      vk::PushConstantRange push_constant_range(
+        vk::ShaderStageFlagBits::eCompute,                              // VkShaderStageFlags             stageFlags
+        0,                                                              // uint32_t                       offset
+        4 * sizeof( uint32_t )                                          // uint32_t                       size
+      );
+      Parameters.DepthDownsamplePipelineLayout = SampleCommon::CreatePipelineLayout( { *frame_resources->DepthDownsampleDescriptorSet.Layout }, { push_constant_range } );
+      Parameters.DepthDownsamplePipeline = CreateComputePipeline( "Data/" PROJECT_NUMBER_STRING "/depth_downsample.comp.spv", *Parameters.DepthDownsamplePipelineLayout );
+    }
+    {
+      vk::PushConstantRange push_constant_range(
+        vk::ShaderStageFlagBits::eCompute,                              // VkShaderStageFlags             stageFlags
+        0,                                                              // uint32_t                       offset
+        6 * sizeof( uint32_t )                                          // uint32_t                       size
+      );
+      Parameters.OcclusionCullingPipelineLayout = SampleCommon::CreatePipelineLayout( { *frame_resources->OcclusionCullingDescriptorSet.Layout }, { push_constant_range } );
+      Parameters.OcclusionCullingPipeline = CreateComputePipeline( "Data/" PROJECT_NUMBER_STRING "/occlusion_culling.comp.spv", *Parameters.OcclusionCullingPipelineLayout );
     }
   }
 
+  vk::UniquePipeline Sample::CreateComputePipeline( char const * filename, vk::PipelineLayout const & pipeline_layout ) const {
+    vk::UniqueShaderModule compute_shader_module = SampleCommon::CreateShaderModule( filename );
+
+    vk::ComputePipelineCreateInfo pipeline_create_info(
+      vk::PipelineCreateFlags( 0 ),                                 // VkPipelineCreateFlags                          flags
+      {                                                             // VkPipelineShaderStageCreateInfo                stage
+        vk::PipelineShaderStageCreateFlags( 0 ),                      // VkPipelineShaderStageCreateFlags               flags
+        vk::ShaderStageFlagBits::eCompute,                            // VkShaderStageFlagBits                          stage
+        *compute_shader_module,                                       // VkShaderModule                                 module
+        "main"                                                        // const char                                    *pName
+      },
+      pipeline_layout,                                              // VkPipelineLayout                               layout
+      vk::Pipeline(),                                               // VkPipeline                                     basePipelineHandle
+      -1                                                            // int32_t                                        basePipelineIndex
+    );
+    return GetDevice().createComputePipelineUnique( vk::PipelineCache(), pipeline_create_info );
+  }
+
 } // namespace ApiWithoutSecrets
@@ -17,7 +17,16 @@
 #if !defined(FRAME_RESOURCES_COUNT_HEADER)
 #define FRAME_RESOURCES_COUNT_HEADER
 
+#include <map>
+#include <array>
+#include <atomic>
+#include <thread>
 #include "SampleCommon.h"
+#include "CpuWorkloadTrace.h"
+#include "SpscQueue.h"
+#include "SimdMath.h"
+#include "RenderQueue.h"
+#include "DescriptorWriter.h"
 
 namespace ApiWithoutSecrets {
 
@@ -30,12 +39,271 @@ namespace ApiWithoutSecrets {
     vk::UniqueCommandPool                 CommandPool;
     vk::UniqueCommandBuffer               PreCommandBuffer;
     vk::UniqueCommandBuffer               PostCommandBuffer;
+    vk::UniqueCommandBuffer               TimestampCommandBuffer;
+    vk::UniqueQueryPool                   TimestampQueryPool;
+    bool                                  TimestampsWritten;
+    ImageParameters                       SceneImage;
+    vk::UniqueFramebuffer                 SceneFramebuffer;
+    StagingBufferParameters               InstanceBuffer;
+    bool                                  InstanceBufferCoherent;
+    DescriptorSetParameters               InstanceDescriptorSet;
+    BufferParameters                      CulledInstanceBuffer;
+    DescriptorSetParameters               CulledInstanceDescriptorSet;
+    StagingBufferParameters               IndirectDrawBuffer;
+    bool                                  IndirectDrawBufferCoherent;
+    DescriptorSetParameters               DepthDownsampleDescriptorSet;
+    DescriptorSetParameters               OcclusionCullingDescriptorSet;
+    bool                                  OcclusionCullingWritten;
+    uint32_t                              OcclusionCullingInputCount;
 
     SampleFrameResourcesData() :
       FrameResourcesData(),
       CommandPool(),
       PreCommandBuffer(),
-      PostCommandBuffer() {
+      PostCommandBuffer(),
+      TimestampCommandBuffer(),
+      TimestampQueryPool(),
+      TimestampsWritten( false ),
+      SceneImage(),
+      SceneFramebuffer(),
+      InstanceBuffer(),
+      InstanceBufferCoherent( false ),
+      InstanceDescriptorSet(),
+      CulledInstanceBuffer(),
+      CulledInstanceDescriptorSet(),
+      IndirectDrawBuffer(),
+      IndirectDrawBufferCoherent( false ),
+      DepthDownsampleDescriptorSet(),
+      OcclusionCullingDescriptorSet(),
+      OcclusionCullingWritten( false ),
+      OcclusionCullingInputCount( 0 ) {
+    }
+  };
+
+  // ************************************************************ //
+  // InstanceData                                                 //
+  //                                                              //
+  // Per-instance record read by shaders from a storage buffer    //
+  // through gl_InstanceIndex; layout matches std430 rules        //
+  // ************************************************************ //
+  struct InstanceData {
+    float       Transform[4];           // <- xy - offset, z - distance, w - scale
+    uint32_t    Color;                  // <- RGBA8
+    uint32_t    TextureIndex;
+    uint32_t    LodLevel;               // <- Selects tessellation of procedurally generated vertices
+    uint32_t    Padding;
+  };
+
+  // ************************************************************ //
+  // OcclusionCullingDescriptorData                               //
+  //                                                              //
+  // Contents of an occlusion culling descriptor set laid out in  //
+  // memory so the set can be written with an update template     //
+  // ************************************************************ //
+  struct OcclusionCullingDescriptorData {
+    vk::DescriptorImageInfo                   DepthPyramid;
+    std::array<vk::DescriptorBufferInfo, 3>   Buffers;        // <- Input instances, culled instances and the indirect draw command
+  };
+
+  // ************************************************************ //
+  // SceneInstancesData                                           //
+  //                                                              //
+  // Structure-of-arrays storage of all instances on the CPU;     //
+  // culling reads only the arrays it needs and processes many    //
+  // instances at once                                            //
+  // ************************************************************ //
+  struct SceneInstancesData {
+    std::vector<float>    BaseX;              // <- Position in the [-1, 1] range, scaled by a world extent into X
+    std::vector<float>    BaseY;
+    std::vector<float>    X;
+    std::vector<float>    Y;
+    std::vector<float>    Z;                  // <- Distance in the [0, 1] range
+    std::vector<float>    Scale;
+    std::vector<uint32_t> Color;
+    std::vector<uint32_t> TextureIndex;
+    std::vector<float>    Radius;             // <- Bounding sphere radius for a current aspect ratio
+    float                 RadiusAspectScale;
+
+    SceneInstancesData() :
+      BaseX(),
+      BaseY(),
+      X(),
+      Y(),
+      Z(),
+      Scale(),
+      Color(),
+      TextureIndex(),
+      Radius(),
+      RadiusAspectScale( 0.0f ) {
+    }
+  };
+
+  // ************************************************************ //
+  // DepthPyramidData                                             //
+  //                                                              //
+  // Hierarchical depth buffer - each texel of a level stores the //
+  // farthest depth of the area it covers in the previous level;  //
+  // level 0 is built from a depth attachment                     //
+  // ************************************************************ //
+  struct DepthPyramidData {
+    ImageParameters                       Image;
+    std::vector<vk::UniqueImageView>      LevelViews;
+    std::vector<DescriptorSetParameters>  LevelDescriptorSets;    // <- Used to downsample previous level, empty for level 0
+    uint32_t                              Width;
+    uint32_t                              Height;
+    uint32_t                              LevelsCount;
+    bool                                  Valid;                  // <- Contains depth of a previous frame
+
+    DepthPyramidData() :
+      Image(),
+      LevelViews(),
+      LevelDescriptorSets(),
+      Width( 0 ),
+      Height( 0 ),
+      LevelsCount( 0 ),
+      Valid( false ) {
+    }
+  };
+
+  // ************************************************************ //
+  // ScenePipelinesData                                           //
+  //                                                              //
+  // Variants of a scene pipeline created for a single pipeline   //
+  // layout and fragment shader                                   //
+  // ************************************************************ //
+  struct ScenePipelinesData {
+    vk::UniquePipeline                    Default;
+    vk::UniquePipeline                    Alternate;              // <- Differs only in a cull mode, used by every other draw batch
+    vk::UniquePipeline                    Procedural;             // <- Generates vertices from an index, no vertex buffer
+    vk::UniquePipeline                    ProceduralAlternate;
+
+    ScenePipelinesData() :
+      Default(),
+      Alternate(),
+      Procedural(),
+      ProceduralAlternate() {
+    }
+  };
+
+  // ************************************************************ //
+  // FrameResourcesControllerData                                 //
+  //                                                              //
+  // State of an automatic selection of the number of frames in   //
+  // flight; measurements are averaged over a window of frames    //
+  // ************************************************************ //
+  struct FrameResourcesControllerData {
+    static const uint32_t   WindowSize = 30;
+
+    uint32_t  FramesInWindow;
+    float     FrameTimeSum;
+    float     FenceWaitTimeSum;
+    float     GpuTimeSum;
+    int       PreviousCount;          // <- Count used before the last change which is being verified, 0 if none
+    float     PreviousFrameTime;
+    bool      Settled;
+    float     SettledCpuTime;
+    float     SettledGpuTime;
+
+    FrameResourcesControllerData() :
+      FramesInWindow( 0 ),
+      FrameTimeSum( 0.0f ),
+      FenceWaitTimeSum( 0.0f ),
+      GpuTimeSum( 0.0f ),
+      PreviousCount( 0 ),
+      PreviousFrameTime( 0.0f ),
+      Settled( false ),
+      SettledCpuTime( 0.0f ),
+      SettledGpuTime( 0.0f ) {
+    }
+  };
+
+  // ************************************************************ //
+  // VertexPathBenchmarkData                                      //
+  //                                                              //
+  // State of a comparison of GPU times of drawing quads from a   //
+  // vertex buffer and from vertices generated in a shader; both  //
+  // paths are measured one after another with the same           //
+  // tessellation                                                 //
+  // ************************************************************ //
+  struct VertexPathBenchmarkData {
+    static const uint32_t   WarmUpFrames = 10;      // <- Timestamps are read a few frames after submission
+    static const uint32_t   MeasuredFrames = 200;
+
+    bool      Running;
+    int       Phase;                  // <- 0 - vertex buffer, 1 - procedural vertices
+    uint32_t  FrameIndex;
+    float     GpuTimeSum;
+    bool      ResultsAvailable;
+    float     Results[2];
+    bool      PreviousProceduralVertices;
+    int       PreviousTessellation;
+
+    VertexPathBenchmarkData() :
+      Running( false ),
+      Phase( 0 ),
+      FrameIndex( 0 ),
+      GpuTimeSum( 0.0f ),
+      ResultsAvailable( false ),
+      Results(),
+      PreviousProceduralVertices( false ),
+      PreviousTessellation( 0 ) {
+    }
+  };
+
+  // ************************************************************ //
+  // SimulationFrameData                                          //
+  //                                                              //
+  // Slot handed between the render and the simulation threads;   //
+  // render thread fills in the work to perform and simulation    //
+  // thread returns timings of the simulated frame                //
+  // ************************************************************ //
+  struct SimulationFrameData {
+    uint64_t                                        Index;
+    float                                           WorkTime;
+    CpuWorkload                                     Workload;
+    std::chrono::high_resolution_clock::time_point  StartTime;
+    float                                           SimulationTime;
+
+    SimulationFrameData() :
+      Index( 0 ),
+      WorkTime( 0.0f ),
+      Workload( CpuWorkload::Trigonometry ),
+      StartTime(),
+      SimulationTime( 0.0f ) {
+    }
+  };
+
+  // ************************************************************ //
+  // SimulationThreadData                                         //
+  //                                                              //
+  // State of a two-thread mode in which a simulation thread      //
+  // prepares frame N+1 while the render thread records and       //
+  // submits frame N; a fixed number of slots circulates through  //
+  // two bounded queues so simulation can't run further ahead     //
+  // ************************************************************ //
+  struct SimulationThreadData {
+    static const size_t                         SlotsCount = 2;
+
+    std::thread                                 Thread;
+    std::atomic<bool>                           StopRequested;
+    SpscQueue<SimulationFrameData, SlotsCount>  Requests;       // <- Render thread -> simulation thread
+    SpscQueue<SimulationFrameData, SlotsCount>  Results;        // <- Simulation thread -> render thread
+    CpuWorkloadData                             Workload;       // <- Used only by the simulation thread
+    uint64_t                                    NextIndex;
+    float                                       WaitTime;
+    float                                       SimulationTime;
+    float                                       Latency;
+
+    SimulationThreadData() :
+      Thread(),
+      StopRequested( false ),
+      Requests(),
+      Results(),
+      Workload(),
+      NextIndex( 0 ),
+      WaitTime( 0.0f ),
+      SimulationTime( 0.0f ),
+      Latency( 0.0f ) {
     }
   };
 
@@ -45,42 +313,204 @@ namespace ApiWithoutSecrets {
   // Sample-specific parameters                                   //
   // ************************************************************ //
   struct SampleParameters {
-    static const int                            MaxObjectsCount = 1000;
+    static const int                            MaxObjectsCount = 100000;
+    static const float                          WorldExtent;
+    static const float                          QuadSize;
     static const int                            QuadTessellation = 40;
+    static const int                            MaxProceduralTessellation = 128;
+    static const int                            LodLevelsCount = 4;         // <- Each level halves tessellation of a previous one
+    static const int                            MaxDrawBatchesCount = 256;
+    static const uint32_t                       MaxBindlessTexturesCount = 1024;
+    static const float                          MinResolutionScale;
+    static const size_t                         FrameTimeSamplesCount = 512;
+    static const uint32_t                       GeneratedTraceFramesCount = 600;
+    static const int                            DescriptorUpdateMethodsCount = 3;
 
     int                                         ObjectsCount;
+    bool                                        LargeWorld;
+    bool                                        CpuCulling;
+    float                                       DrawDistance;
+    uint32_t                                    DrawnObjectsCount;
+    float                                       CullingTime;
+    float                                       CameraX;
+    float                                       CameraY;
+    bool                                        OcclusionCullingSupported;
+    bool                                        OcclusionCulling;
+    uint32_t                                    OccludedObjectsCount;
+    int                                         DrawBatchesCount;
+    bool                                        SortDrawPackets;
+    RenderQueue                                 SceneQueue;
+    RenderQueueStatistics                       SceneQueueStatistics;
+    bool                                        ProceduralVertices;
+    int                                         ProceduralTessellation;
+    VertexPathBenchmarkData                     VertexPathBenchmark;
+    bool                                        LevelOfDetail;
+    float                                       LodDistance;                // <- Distance at which the coarsest level is used
+    std::array<uint32_t, LodLevelsCount>        QuadLodMeshes;              // <- Meshes of levels in the geometry arena
+    std::array<uint32_t, LodLevelsCount + 1>    LodFirstInstance;           // <- Ranges of visible instances using each level
+    uint64_t                                    DrawnTrianglesCount;
+    uint64_t                                    FullDetailTrianglesCount;
     int                                         PreSubmitCpuWorkTime;
     int                                         PostSubmitCpuWorkTime;
+    int                                         CpuWorkTasksCount;
+    int                                         SelectedCpuWorkload;
+    bool                                        ReplayCpuWorkloadTrace;
+    int                                         SelectedCpuWorkloadDistribution;
+    float                                       CpuWorkloadDeviation;
+    CpuWorkloadTrace                            CpuTrace;
+    uint64_t                                    CpuTraceFrameIndex;
+    std::vector<float>                          FrameTimeSamples;
+    size_t                                      NextFrameTimeSample;
+    int                                         FrameTimeSamplesResourcesCount;
+    std::map<int, std::array<float, 3>>         FrameTimePercentiles;   // <- p50, p90 and p99 for each frame resources count
+    Math::BenchmarkResults                      SimdBenchmark;
+    bool                                        SeparateSimulationThread;
+    SimulationThreadData                        Simulation;
     float                                       FrameGenerationTime;
     float                                       TotalFrameTime;
     int                                         FrameResourcesCount;
+    bool                                        AdaptiveFrameResourcesCount;
+    FrameResourcesControllerData                FrameResourcesController;
+    bool                                        TimestampsSupported;
+    float                                       TimestampPeriod;
+    uint64_t                                    TimestampMask;
+    float                                       LastGpuTime;
+    float                                       GpuTime;
+    bool                                        UseMipmaps;
+    bool                                        BindlessSupported;
+    bool                                        BindlessTextures;
+    bool                                        RewriteFrameDescriptorSets;
+    int                                         DescriptorUpdateMethod;     // <- 0 - individual writes, 1 - batched writes, 2 - update templates
+    std::array<float, DescriptorUpdateMethodsCount> DescriptorUpdateTimes;  // <- CPU time of writing a single descriptor set in microseconds
+    DescriptorWriter                            FrameDescriptorWriter;
+    int                                         SwapChainImageCount;
+    bool                                        SwapChainImageCountEdited;
+    bool                                        DynamicResolutionSupported;
+    bool                                        DynamicResolution;
+    float                                       GpuTimeBudget;
+    float                                       ResolutionScale;
+    std::map<std::pair<vk::PresentModeKHR, uint32_t>, float>  MeasuredLatencies;
 
     vk::UniqueRenderPass                        RenderPass;
     vk::UniqueRenderPass                        PostRenderPass;
+    vk::UniqueRenderPass                        SceneRenderPass;
+    vk::Filter                                  UpscaleFilter;
     DescriptorSetParameters                     DescriptorSet;
+    DescriptorSetParameters                     AlternateDescriptorSet;   // <- Same textures, used by every other pair of draw batches
+    DescriptorSetParameters                     BindlessDescriptorSet;    // <- Array of all registered textures, selected with a per-instance index
+    std::vector<ImageParameters const *>        BindlessTextureTable;
     ImageParameters                             BackgroundTexture;
     ImageParameters                             Texture;
+    vk::UniqueSampler                           BaseLevelSampler;
     vk::UniquePipelineLayout                    PipelineLayout;
-    vk::UniquePipeline                          GraphicsPipeline;
-    BufferParameters                            VertexBuffer;
-    BufferParameters                            InstanceBuffer;
+    vk::UniquePipelineLayout                    BindlessPipelineLayout;
+    ScenePipelinesData                          Pipelines;
+    ScenePipelinesData                          BindlessPipelines;
+    GeometryArenaParameters                     Geometry;
+    SceneInstancesData                          Instances;
+    std::vector<uint32_t>                       VisibleInstances;
+    std::vector<uint32_t>                       InstanceLodLevels;
+    std::vector<uint32_t>                       LodSortedInstances;
+    DepthPyramidData                            DepthPyramid;
+    vk::UniquePipelineLayout                    DepthDownsamplePipelineLayout;
+    vk::UniquePipeline                          DepthDownsamplePipeline;
+    vk::UniquePipelineLayout                    OcclusionCullingPipelineLayout;
+    vk::UniquePipeline                          OcclusionCullingPipeline;
+    vk::UniqueDescriptorUpdateTemplate          InstanceUpdateTemplate;
+    vk::UniqueDescriptorUpdateTemplate          OcclusionCullingUpdateTemplate;
 
     SampleParameters() :
       ObjectsCount( 100 ),
+      LargeWorld( false ),
+      CpuCulling( true ),
+      DrawDistance( 1.0f ),
+      DrawnObjectsCount( 0 ),
+      CullingTime( 0.0f ),
+      CameraX( 0.0f ),
+      CameraY( 0.0f ),
+      OcclusionCullingSupported( false ),
+      OcclusionCulling( false ),
+      OccludedObjectsCount( 0 ),
+      DrawBatchesCount( 1 ),
+      SortDrawPackets( true ),
+      SceneQueue(),
+      SceneQueueStatistics(),
+      ProceduralVertices( false ),
+      ProceduralTessellation( QuadTessellation ),
+      VertexPathBenchmark(),
+      LevelOfDetail( true ),
+      LodDistance( 1.0f ),
+      QuadLodMeshes(),
+      LodFirstInstance(),
+      DrawnTrianglesCount( 0 ),
+      FullDetailTrianglesCount( 0 ),
       PreSubmitCpuWorkTime( 0 ),
       PostSubmitCpuWorkTime( 0 ),
+      CpuWorkTasksCount( 1 ),
+      SelectedCpuWorkload( static_cast<int>(CpuWorkload::Trigonometry) ),
+      ReplayCpuWorkloadTrace( false ),
+      SelectedCpuWorkloadDistribution( static_cast<int>(CpuWorkloadDistribution::LogNormal) ),
+      CpuWorkloadDeviation( 0.25f ),
+      CpuTrace(),
+      CpuTraceFrameIndex( 0 ),
+      FrameTimeSamples(),
+      NextFrameTimeSample( 0 ),
+      FrameTimeSamplesResourcesCount( 0 ),
+      FrameTimePercentiles(),
+      SimdBenchmark(),
+      SeparateSimulationThread( false ),
+      Simulation(),
       FrameGenerationTime( 0 ),
       TotalFrameTime( 0 ),
       FrameResourcesCount( 1 ),
+      AdaptiveFrameResourcesCount( false ),
+      FrameResourcesController(),
+      TimestampsSupported( false ),
+      TimestampPeriod( 0.0f ),
+      TimestampMask( 0 ),
+      LastGpuTime( 0.0f ),
+      GpuTime( 0.0f ),
+      UseMipmaps( true ),
+      BindlessSupported( false ),
+      BindlessTextures( false ),
+      RewriteFrameDescriptorSets( false ),
+      DescriptorUpdateMethod( 1 ),
+      DescriptorUpdateTimes(),
+      FrameDescriptorWriter(),
+      SwapChainImageCount( 3 ),
+      SwapChainImageCountEdited( false ),
+      DynamicResolutionSupported( false ),
+      DynamicResolution( false ),
+      GpuTimeBudget( 8.0f ),
+      ResolutionScale( 1.0f ),
+      MeasuredLatencies(),
       RenderPass(),
       PostRenderPass(),
+      SceneRenderPass(),
+      UpscaleFilter( vk::Filter::eNearest ),
       DescriptorSet(),
+      AlternateDescriptorSet(),
+      BindlessDescriptorSet(),
+      BindlessTextureTable(),
       BackgroundTexture(),
       Texture(),
+      BaseLevelSampler(),
       PipelineLayout(),
-      GraphicsPipeline(),
-      VertexBuffer(),
-      InstanceBuffer() {
+      BindlessPipelineLayout(),
+      Pipelines(),
+      BindlessPipelines(),
+      Geometry(),
+      Instances(),
+      VisibleInstances(),
+      InstanceLodLevels(),
+      LodSortedInstances(),
+      DepthPyramid(),
+      DepthDownsamplePipelineLayout(),
+      DepthDownsamplePipeline(),
+      OcclusionCullingPipelineLayout(),
+      OcclusionCullingPipeline(),
+      InstanceUpdateTemplate(),
+      OcclusionCullingUpdateTemplate() {
     }
   };
 
@@ -102,17 +532,54 @@ namespace ApiWithoutSecrets {
 
     virtual void    Draw() override;
     void            DrawSample( CurrentFrameData & current_frame );
+    void            UpdateGpuTime( SampleFrameResourcesData & frame_resources );
+    void            UpdateFrameResourcesCount( float frame_time, float fence_wait_time, float gpu_time );
+    void            UpdateResolutionScale( float gpu_time );
+    void            PlaceInstances();
+    uint32_t        PrepareInstances( SampleFrameResourcesData & frame_resources, float aspect_scale, float & camera_offset_x, float & camera_offset_y );
+    void            CullOccludedInstances( SampleFrameResourcesData & frame_resources, vk::CommandBuffer & command_buffer, uint32_t instances_count, float aspect_scale, float camera_offset_x, float camera_offset_y );
+    void            BuildDepthPyramid( SampleFrameResourcesData & frame_resources, vk::CommandBuffer & command_buffer, vk::Extent2D const & render_extent );
+    void            UpdateOccludedObjectsCount( SampleFrameResourcesData & frame_resources );
+    void            SubmitSceneDrawPackets( SampleFrameResourcesData & frame_resources, uint32_t instances_count );
+    void            BucketInstancesByLod( uint32_t instances_count );
+    uint32_t        GetQuadVertexCount( uint32_t lod_level ) const;
+    void            SetQuadGeometry( DrawPacket & packet, uint32_t lod_level ) const;
+    void            StartVertexPathBenchmark();
+    void            UpdateVertexPathBenchmark( float gpu_time );
+    void            UpdateFrameTimePercentiles( float frame_time );
+    void            ResetFrameTimePercentiles();
+    void            GetCpuWorkTimes( float & pre_submit_time, float & post_submit_time );
+    void            RequestSimulation( SimulationFrameData & frame );
+    void            StartSimulationThread();
+    void            StopSimulationThread();
+    void            SimulationLoop();
 
     virtual void    OnSampleWindowSizeChanged_Pre() override;
     virtual void    OnSampleWindowSizeChanged_Post() override;
 
     void            CreateFrameResources();
     void            CreateRenderPasses();
+    void            CreateSceneTargets();
     void            CreateDescriptorSet();
     void            CreateTextures();
+    void            CreateTexture( std::string const & filename, ImageParameters & texture );
+    bool            CreateCompressedTexture( std::string const & filename, ImageParameters & texture );
+    void            UpdateTextureDescriptors();
+    uint32_t        RegisterBindlessTexture( ImageParameters const & texture );
+    void            WriteBindlessTextureDescriptor( DescriptorWriter & writer, uint32_t index ) const;
     void            CreatePipelineLayout();
     void            CreateGraphicsPipeline();
+    ScenePipelinesData CreateScenePipelines( vk::PipelineLayout const & pipeline_layout, char const * fragment_shader_filename ) const;
     void            CreateVertexBuffers();
+    void            CreateDepthPyramid();
+    void            CreateOcclusionCullingPipelines();
+    vk::UniquePipeline CreateComputePipeline( char const * filename, vk::PipelineLayout const & pipeline_layout ) const;
+    DescriptorSetParameters CreateDepthDownsampleDescriptorSet( vk::ImageView const & source_view, vk::ImageLayout source_layout, vk::ImageView const & destination_view ) const;
+    DescriptorSetParameters CreateOcclusionCullingDescriptorSet( SampleFrameResourcesData const & frame_resources ) const;
+    OcclusionCullingDescriptorData GetOcclusionCullingDescriptorData( SampleFrameResourcesData const & frame_resources ) const;
+    DescriptorSetParameters CreateInstanceDescriptorSet( vk::Buffer const & instance_buffer ) const;
+    void            CreateDescriptorUpdateTemplates();
+    void            RewriteFrameDescriptorSets( SampleFrameResourcesData & frame_resources );
   };
 
 } // namespace ApiWithoutSecrets
@@ -0,0 +1,26 @@
+// Copyright 2016 Intel Corporation All Rights Reserved
+// 
+// Intel makes no representations about the suitability of this software for any purpose.
+// THIS SOFTWARE IS PROVIDED ""AS IS."" INTEL SPECIFICALLY DISCLAIMS ALL WARRANTIES,
+// EXPRESS OR IMPLIED, AND ALL LIABILITY, INCLUDING CONSEQUENTIAL AND OTHER INDIRECT DAMAGES,
+// FOR THE USE OF THIS SOFTWARE, INCLUDING LIABILITY FOR INFRINGEMENT OF ANY PROPRIETARY
+// RIGHTS, AND INCLUDING THE WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+// Intel does not assume any responsibility for any errors which may appear in this software
+// nor any responsibility to update it.
+
+#version 450
+
+layout(set=0, binding=0) uniform sampler2D u_BackgroundTexture;
+
+layout(set=0, binding=1) uniform sampler2D u_BenchmarkTexture;
+
+layout(location = 0) in vec2 v_Texcoord;
+layout(location = 1) in float v_Distance;
+
+layout(location = 0) out vec4 o_Color;
+
+void main() {
+  vec4 backgroud_image = texture( u_BackgroundTexture, v_Texcoord );
+  vec4 benchmark_image = texture( u_BenchmarkTexture, v_Texcoord );
+  o_Color = v_Distance * mix( backgroud_image, benchmark_image, benchmark_image.a );
+}
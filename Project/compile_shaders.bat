@@ -59,6 +59,11 @@ if exist %folder%\%2.frag (
     glslangValidator.exe -V -H -o %folder%\%2.frag.spv %folder%\%2.frag > %folder%\%2.frag.spv.txt
 )
 
+if exist %folder%\%2.comp (
+    echo Converting the following shader file: %folder%\%2.comp
+    glslangValidator.exe -V -H -o %folder%\%2.comp.spv %folder%\%2.comp > %folder%\%2.comp.spv.txt
+)
+
 set target=build\Data\%1
 if exist %target% (
     echo Copying files to %target%: